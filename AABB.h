@@ -0,0 +1,131 @@
+#pragma once
+
+
+#include <limits>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include "Vector.h"
+#include "common.h"
+#include "parallel.h"
+
+
+template <size_t N, detail::numeric T>
+struct AABB {
+    Vector<N, T> lo, hi;
+
+
+    // empty box, lo > hi so that expand and merge need no special case
+    constexpr AABB() noexcept : lo(std::numeric_limits<T>::max()), hi(std::numeric_limits<T>::lowest()) {}
+
+    constexpr explicit AABB(const Vector<N, T>& p) noexcept : lo(p), hi(p) {}
+
+    constexpr AABB(const Vector<N, T>& lo, const Vector<N, T>& hi) noexcept : lo(lo), hi(hi) {}
+
+
+    [[nodiscard]] constexpr bool empty() const noexcept {
+        return (lo > hi).any();
+    }
+
+    [[nodiscard]] constexpr auto center() const noexcept {
+        return (lo + hi) / 2;
+    }
+
+    [[nodiscard]] constexpr auto extent() const noexcept {
+        return hi - lo;
+    }
+
+
+    constexpr AABB& expand(const Vector<N, T>& p) noexcept {
+        lo = min(lo, p);
+        hi = max(hi, p);
+        return *this;
+    }
+
+    constexpr AABB& merge(const AABB& b) noexcept {
+        lo = min(lo, b.lo);
+        hi = max(hi, b.hi);
+        return *this;
+    }
+
+
+    [[nodiscard]] constexpr bool contains(const Vector<N, T>& p) const noexcept {
+        return (lo <= p && p <= hi).all();
+    }
+
+    [[nodiscard]] constexpr bool contains(const AABB& b) const noexcept {
+        return (lo <= b.lo && b.hi <= hi).all();
+    }
+
+    [[nodiscard]] constexpr bool intersects(const AABB& b) const noexcept {
+        return (lo <= b.hi && b.lo <= hi).all();
+    }
+
+    // slab test against origin + t * dir for t in [t_min, t_max], inv_dir = 1 / dir
+    // returns the entry distance; a ray lying in a slab plane (0 * inf = NaN) misses, as does an entry at infinity
+    [[nodiscard]] constexpr std::optional<T> intersect(const Vector<N, T>& origin, const Vector<N, T>& inv_dir, T t_min = 0, T t_max = std::numeric_limits<T>::infinity()) const noexcept
+        requires detail::floating<T>
+    {
+        const Vector<N, T> t0 = (lo - origin) * inv_dir;
+        const Vector<N, T> t1 = (hi - origin) * inv_dir;
+        const Vector<N, T> t_near = min(t0, t1);
+        const Vector<N, T> t_far = max(t0, t1);
+        for (size_t i = 0; i < N; i++) {
+            // min/max would pass the NaN on or drop it depending on the operand order
+            if (t0[i] != t0[i] || t1[i] != t1[i]) {
+                return std::nullopt;
+            }
+            t_min = t_near[i] > t_min ? t_near[i] : t_min;
+            t_max = t_far[i] < t_max ? t_far[i] : t_max;
+        }
+        if (t_min <= t_max && t_min < std::numeric_limits<T>::infinity()) {
+            return t_min;
+        }
+        return std::nullopt;
+    }
+};
+
+
+template <size_t N, detail::numeric T>
+AABB(Vector<N, T>) -> AABB<N, T>;
+
+
+namespace detail {
+    // four independent min/max chains hide the latency of each packed min/max, then fold as a tree
+    template <size_t N, numeric T>
+    [[nodiscard]] constexpr AABB<N, T> bounds(const Vector<N, T>* points, size_t n) noexcept {
+        AABB<N, T> b[4];
+        size_t i = 0;
+        for (; i + 4 <= n; i += 4) {
+            b[0].expand(points[i]);
+            b[1].expand(points[i + 1]);
+            b[2].expand(points[i + 2]);
+            b[3].expand(points[i + 3]);
+        }
+        for (; i < n; i++) {
+            b[0].expand(points[i]);
+        }
+        return b[0].merge(b[1]).merge(b[2].merge(b[3]));
+    }
+}// namespace detail
+
+
+// bounding box of points, spread over threads (0 = all hardware threads) once there are enough points to pay for them
+template <size_t N, detail::numeric T>
+[[nodiscard]] AABB<N, T> bounds(std::span<const Vector<N, T>> points, size_t threads = 1) {
+    constexpr size_t grain = 1 << 16;
+    const size_t chunks = detail::chunk_count(points.size(), threads, grain);
+    if (chunks == 1) {
+        return detail::bounds(points.data(), points.size());
+    }
+    std::vector<AABB<N, T>> partial(chunks);
+    detail::parallel_chunks(points.size(), chunks, [&](size_t c, size_t begin, size_t end) {
+        partial[c] = detail::bounds(points.data() + begin, end - begin);
+    });
+    AABB<N, T> b;
+    for (const AABB<N, T>& p : partial) {
+        b.merge(p);
+    }
+    return b;
+}
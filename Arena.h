@@ -0,0 +1,205 @@
+#pragma once
+
+
+#include <cstdint>
+#include <cstring>
+
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <memory_resource>
+#include <new>
+#include <span>
+#include <vector>
+
+#include "Vector.h"
+#include "bulk.h"
+
+
+namespace detail {
+#if defined(__AVX512F__)
+    constexpr size_t simd_alignment = 64;
+#elif defined(__AVX__)
+    constexpr size_t simd_alignment = 32;
+#else
+    constexpr size_t simd_alignment = 16;
+#endif
+}// namespace detail
+
+
+// bump allocator for per-frame temporaries, reset() rewinds it in O(1)
+// allocations that do not fit are served from the heap until the next reset(), which then grows the arena to the high-water mark
+class Arena : public std::pmr::memory_resource {
+public:
+    explicit Arena(size_t capacity, size_t alignment = detail::simd_alignment) : alignment(alignment), capacity(capacity), head(allocate_block(capacity)) {}
+
+    Arena(const Arena&) = delete;
+
+    Arena& operator=(const Arena&) = delete;
+
+    ~Arena() override {
+        release_overflow();
+        ::operator delete(head, std::align_val_t{alignment});
+    }
+
+
+    void reset() {
+        if (overflow) [[unlikely]] {
+            const size_t required = capacity + overflow_bytes;
+            release_overflow();
+            ::operator delete(head, std::align_val_t{alignment});
+            head = nullptr;
+            capacity = 0;
+            head = allocate_block(required);
+            capacity = required;
+        }
+        offset = 0;
+    }
+
+    [[nodiscard]] size_t used() const noexcept {
+        return offset + overflow_bytes;
+    }
+
+    [[nodiscard]] size_t size() const noexcept {
+        return capacity;
+    }
+
+private:
+    struct Overflow {
+        Overflow* next;
+    };
+
+
+    std::byte* allocate_block(size_t bytes) const {
+        return static_cast<std::byte*>(::operator new(bytes, std::align_val_t{alignment}));
+    }
+
+    void release_overflow() noexcept {
+        while (overflow) {
+            Overflow* next = overflow->next;
+            ::operator delete(overflow);
+            overflow = next;
+        }
+        overflow_bytes = 0;
+    }
+
+
+    void* do_allocate(size_t bytes, size_t align) override {
+        align = std::max(align, alignment);
+        const uintptr_t base = reinterpret_cast<uintptr_t>(head);
+        const uintptr_t begin = (base + offset + align - 1) & ~(align - 1);
+        if (begin + bytes <= base + capacity) [[likely]] {
+            offset = begin + bytes - base;
+            return head + (begin - base);
+        }
+
+        const size_t total = sizeof(Overflow) + bytes + align;
+        auto* block = static_cast<Overflow*>(::operator new(total));
+        block->next = overflow;
+        overflow = block;
+        overflow_bytes += total;
+        const uintptr_t p = (reinterpret_cast<uintptr_t>(block + 1) + align - 1) & ~(align - 1);
+        return reinterpret_cast<std::byte*>(block) + (p - reinterpret_cast<uintptr_t>(block));
+    }
+
+    void do_deallocate(void*, size_t, size_t) override {}// memory is reclaimed by reset()
+
+    [[nodiscard]] bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+
+
+    size_t alignment;
+    size_t capacity;
+    std::byte* head;
+    size_t offset = 0;
+    Overflow* overflow = nullptr;
+    size_t overflow_bytes = 0;
+};
+
+
+// growable container drawing from an Arena, e.g. ArenaVector<3, float> v(&arena);
+template <size_t N, detail::numeric T>
+using ArenaVector = std::pmr::vector<Vector<N, T>>;
+
+
+// fixed-size batch of Vectors carved out of an Arena, the storage is reclaimed by Arena::reset()
+template <size_t N, detail::numeric T>
+class VectorBatch {
+    using V = Vector<N, T>;
+
+public:
+    using value_type = V;
+
+
+    // zero-initialized
+    VectorBatch(Arena& arena, size_t n) : first(allocate(arena, n)), count(n) {
+        bulk_fill(std::span<V>(*this), V());
+    }
+
+    // broadcast, every element is Vector<N, T>(e)
+    VectorBatch(Arena& arena, size_t n, T e) : first(allocate(arena, n)), count(n) {
+        bulk_fill(std::span<V>(*this), V(e));
+    }
+
+    // element i is Vector<N, T>(buffer + i * N)
+    VectorBatch(Arena& arena, size_t n, const T* const buffer) : first(allocate(arena, n)), count(n) {
+        if constexpr (sizeof(V) == N * sizeof(T)) {
+            std::memcpy(static_cast<void*>(first), buffer, count * sizeof(V));
+        } else {
+            for (size_t i = 0; i < count; i++) {
+                std::construct_at(first + i, buffer + i * N);
+            }
+        }
+    }
+
+    // element i is Vector<N, T>(std::invoke(proj, src[i])), proj is typically a swizzle member such as &Vector<3, T>::zyx
+    template <size_t M, typename Proj>
+    VectorBatch(Arena& arena, std::span<const Vector<M, T>> src, Proj proj) : first(allocate(arena, src.size())), count(src.size()) {
+        for (size_t i = 0; i < count; i++) {
+            std::construct_at(first + i, std::invoke(proj, src[i]));
+        }
+    }
+
+    VectorBatch(const VectorBatch&) = delete;
+
+    VectorBatch& operator=(const VectorBatch&) = delete;
+
+
+    [[nodiscard]] V& operator[](size_t i) const noexcept {
+        return first[i];
+    }
+
+    [[nodiscard]] V* data() const noexcept {
+        return first;
+    }
+
+    [[nodiscard]] size_t size() const noexcept {
+        return count;
+    }
+
+    [[nodiscard]] V* begin() const noexcept {
+        return first;
+    }
+
+    [[nodiscard]] V* end() const noexcept {
+        return first + count;
+    }
+
+    operator std::span<V>() const noexcept {
+        return {first, count};
+    }
+
+    operator std::span<const V>() const noexcept {
+        return {first, count};
+    }
+
+private:
+    static V* allocate(Arena& arena, size_t n) {
+        return static_cast<V*>(arena.allocate(n * sizeof(V), std::max(alignof(V), detail::simd_alignment)));
+    }
+
+
+    V* first;
+    size_t count;
+};
@@ -0,0 +1,368 @@
+#pragma once
+
+
+#include <cmath>
+#include <cstdint>
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <optional>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include "AABB.h"
+#include "Vector.h"
+#include "geometric.h"
+#include "parallel.h"
+
+
+// 4-wide bounding volume hierarchy over a point set, answering nearest-neighbor, radius and ray queries
+// every node holds the boxes of its 4 children lane-packed per axis, so one node visit tests all of them in a single pass
+template <size_t N, detail::floating T>
+class BVH {
+    using V = Vector<N, T>;
+
+public:
+    static constexpr size_t width = 4;
+    static constexpr size_t leaf_size = 8;
+
+    struct Neighbor {
+        uint32_t index;// into the span the BVH was built from
+        T distance2;
+    };
+
+    struct Hit {
+        uint32_t index;
+        T t;
+    };
+
+
+    // median split along the widest axis, the top levels are built on up to threads threads (0 = all hardware threads)
+    explicit BVH(std::span<const V> points, size_t threads = 1) : ids(points.size()) {
+        std::iota(ids.begin(), ids.end(), uint32_t{0});
+        if (!points.empty()) {
+            build(nodes, points.data(), 0, static_cast<uint32_t>(points.size()), detail::thread_count(threads));
+        }
+        this->points.reserve(points.size());
+        for (const uint32_t id : ids) {
+            this->points.push_back(points[id]);
+        }
+    }
+
+
+    [[nodiscard]] size_t size() const noexcept {
+        return points.size();
+    }
+
+    [[nodiscard]] std::optional<Neighbor> nearest(const V& q) const noexcept {
+        Neighbor n[1];
+        if (knn(q, n) == 0) {
+            return std::nullopt;
+        }
+        return n[0];
+    }
+
+    // the out.size() nearest points sorted by distance, returns how many were found
+    size_t knn(const V& q, std::span<Neighbor> out) const noexcept {
+        const size_t k = out.size();
+        if (k == 0 || nodes.empty()) {
+            return 0;
+        }
+        const auto farther = [](const Neighbor& a, const Neighbor& b) { return a.distance2 < b.distance2; };
+        size_t found = 0;
+        const auto worst = [&] { return found < k ? std::numeric_limits<T>::infinity() : out[0].distance2; };
+
+        Entry stack[stack_size];
+        size_t top = 0;
+        stack[top++] = {0, 0};
+        while (top) {
+            const Entry e = stack[--top];
+            if (e.d2 > worst()) {
+                continue;
+            }
+            const Node& node = nodes[e.node];
+            T d2[width];
+            box_distance2(node, q, d2);
+            uint32_t lanes[width]{0, 1, 2, 3};
+            std::sort(lanes, lanes + width, [&](uint32_t a, uint32_t b) { return d2[a] < d2[b]; });
+
+            // leaves nearest first, then inner children pushed farthest first so the nearest is popped next
+            for (const uint32_t l : lanes) {
+                if (node.count[l] == 0 || d2[l] > worst()) {
+                    continue;
+                }
+                for (uint32_t i = node.child[l]; i < node.child[l] + node.count[l]; i++) {
+                    const V diff = points[i] - q;
+                    const T dd = dot(diff, diff);
+                    if (found < k) {
+                        out[found++] = {ids[i], dd};
+                        std::push_heap(out.begin(), out.begin() + found, farther);
+                    } else if (dd < out[0].distance2) {
+                        std::pop_heap(out.begin(), out.end(), farther);
+                        out[k - 1] = {ids[i], dd};
+                        std::push_heap(out.begin(), out.end(), farther);
+                    }
+                }
+            }
+            for (size_t j = width; j-- > 0;) {
+                const uint32_t l = lanes[j];
+                if (node.count[l] == 0 && node.child[l] != empty && d2[l] <= worst()) {
+                    stack[top++] = {node.child[l], d2[l]};
+                }
+            }
+        }
+        std::sort_heap(out.begin(), out.begin() + found, farther);
+        return found;
+    }
+
+    // appends the indices of all points within r of q
+    void radius(const V& q, T r, std::vector<uint32_t>& out) const {
+        if (nodes.empty()) {
+            return;
+        }
+        const T r2 = r * r;
+        uint32_t stack[stack_size];
+        size_t top = 0;
+        stack[top++] = 0;
+        while (top) {
+            const Node& node = nodes[stack[--top]];
+            T d2[width];
+            box_distance2(node, q, d2);
+            for (size_t l = 0; l < width; l++) {
+                if (node.child[l] == empty || d2[l] > r2) {
+                    continue;
+                }
+                if (node.count[l] == 0) {
+                    stack[top++] = node.child[l];
+                    continue;
+                }
+                for (uint32_t i = node.child[l]; i < node.child[l] + node.count[l]; i++) {
+                    const V diff = points[i] - q;
+                    if (dot(diff, diff) <= r2) {
+                        out.push_back(ids[i]);
+                    }
+                }
+            }
+        }
+    }
+
+    // first point whose sphere of radius r is hit by origin + t * dir, dir of unit length, t in [0, t_max]
+    [[nodiscard]] std::optional<Hit> raycast(const V& origin, const V& dir, T r, T t_max = std::numeric_limits<T>::infinity()) const noexcept {
+        if (nodes.empty()) {
+            return std::nullopt;
+        }
+        const V inv_dir = T{1} / dir;
+        std::optional<Hit> best;
+        Entry stack[stack_size];
+        size_t top = 0;
+        stack[top++] = {0, 0};
+        while (top) {
+            const Entry e = stack[--top];
+            if (e.d2 > t_max) {
+                continue;
+            }
+            const Node& node = nodes[e.node];
+            T t_enter[width], t_exit[width];
+            box_slabs(node, origin, inv_dir, r, t_max, t_enter, t_exit);
+            uint32_t lanes[width]{0, 1, 2, 3};
+            std::sort(lanes, lanes + width, [&](uint32_t a, uint32_t b) { return t_enter[a] > t_enter[b]; });
+            for (const uint32_t l : lanes) {
+                if (node.child[l] == empty || t_enter[l] > t_exit[l] || t_enter[l] > t_max) {
+                    continue;
+                }
+                if (node.count[l] == 0) {
+                    stack[top++] = {node.child[l], t_enter[l]};
+                    continue;
+                }
+                for (uint32_t i = node.child[l]; i < node.child[l] + node.count[l]; i++) {
+                    const V oc = points[i] - origin;
+                    const T b = dot(oc, dir);
+                    const T disc = b * b - (dot(oc, oc) - r * r);
+                    if (disc < 0) {
+                        continue;
+                    }
+                    const T s = std::sqrt(disc);
+                    const T t = b - s >= 0 ? b - s : b + s;
+                    if (t >= 0 && t <= t_max) {
+                        t_max = t;
+                        best = Hit{ids[i], t};
+                    }
+                }
+            }
+        }
+        return best;
+    }
+
+
+    // batched versions spread over threads (0 = all hardware threads)
+    // knn writes queries.size() rows of k neighbors, rows with fewer than k points are padded with index UINT32_MAX
+    void knn(std::span<const V> queries, size_t k, std::span<Neighbor> out, size_t threads = 1) const noexcept {
+        detail::parallel_chunks(queries.size(), detail::chunk_count(queries.size(), threads, 256), [&](size_t, size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) {
+                const std::span<Neighbor> row = out.subspan(i * k, k);
+                std::fill(row.begin() + knn(queries[i], row), row.end(), Neighbor{empty, std::numeric_limits<T>::infinity()});
+            }
+        });
+    }
+
+    [[nodiscard]] std::vector<std::vector<uint32_t>> radius(std::span<const V> queries, T r, size_t threads = 1) const {
+        std::vector<std::vector<uint32_t>> out(queries.size());
+        detail::parallel_chunks(queries.size(), detail::chunk_count(queries.size(), threads, 256), [&](size_t, size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) {
+                radius(queries[i], r, out[i]);
+            }
+        });
+        return out;
+    }
+
+    void raycast(std::span<const V> origins, std::span<const V> dirs, T r, std::span<std::optional<Hit>> out, size_t threads = 1) const noexcept {
+        detail::parallel_chunks(origins.size(), detail::chunk_count(origins.size(), threads, 256), [&](size_t, size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) {
+                out[i] = raycast(origins[i], dirs[i], r);
+            }
+        });
+    }
+
+private:
+    static constexpr uint32_t empty = std::numeric_limits<uint32_t>::max();
+    static constexpr size_t stack_size = 256;
+
+
+    struct Node {
+        T lo[N][width], hi[N][width];
+        uint32_t child[width];// node index for inner lanes, first point for leaf lanes, empty for unused lanes
+        uint32_t count[width];// point count for leaf lanes, 0 otherwise
+    };
+
+    struct Entry {
+        uint32_t node;
+        T d2;// squared box distance for point queries, entry distance for rays
+    };
+
+
+    // per lane squared distance from q to the child box, unused lanes come out as infinity
+    static void box_distance2(const Node& node, const V& q, T (&d2)[width]) noexcept {
+        std::fill_n(d2, width, T{0});
+        for (size_t a = 0; a < N; a++) {
+            const T c = q[a];
+            for (size_t l = 0; l < width; l++) {
+                const T d = std::max({node.lo[a][l] - c, c - node.hi[a][l], T{0}});
+                d2[l] += d * d;
+            }
+        }
+    }
+
+    // per lane slab interval of the child box grown by r
+    static void box_slabs(const Node& node, const V& origin, const V& inv_dir, T r, T t_max, T (&t_enter)[width], T (&t_exit)[width]) noexcept {
+        std::fill_n(t_enter, width, T{0});
+        std::fill_n(t_exit, width, t_max);
+        for (size_t a = 0; a < N; a++) {
+            for (size_t l = 0; l < width; l++) {
+                const T t0 = (node.lo[a][l] - r - origin[a]) * inv_dir[a];
+                const T t1 = (node.hi[a][l] + r - origin[a]) * inv_dir[a];
+                t_enter[l] = std::max(t_enter[l], std::min(t0, t1));
+                t_exit[l] = std::min(t_exit[l], std::max(t0, t1));
+            }
+        }
+    }
+
+
+    AABB<N, T> range_bounds(const V* src, uint32_t begin, uint32_t end) const noexcept {
+        AABB<N, T> b;
+        for (uint32_t i = begin; i < end; i++) {
+            b.expand(src[ids[i]]);
+        }
+        return b;
+    }
+
+    // partitions ids[begin, end) around its median along the widest axis
+    uint32_t split(const V* src, uint32_t begin, uint32_t end) {
+        const V extent = range_bounds(src, begin, end).extent();
+        size_t axis = 0;
+        for (size_t a = 1; a < N; a++) {
+            axis = extent[a] > extent[axis] ? a : axis;
+        }
+        const uint32_t mid = begin + (end - begin) / 2;
+        std::nth_element(ids.begin() + begin, ids.begin() + mid, ids.begin() + end, [&](uint32_t a, uint32_t b) { return src[a][axis] < src[b][axis]; });
+        return mid;
+    }
+
+    // appends the subtree of ids[begin, end) to out and returns its root
+    uint32_t build(std::vector<Node>& out, const V* src, uint32_t begin, uint32_t end, size_t threads) {
+        std::pair<uint32_t, uint32_t> ranges[width];
+        size_t n = 0;
+        if (end - begin <= leaf_size) {
+            ranges[n++] = {begin, end};
+        } else {
+            const uint32_t mid = split(src, begin, end);
+            for (const auto& [b, e] : {std::pair{begin, mid}, std::pair{mid, end}}) {
+                if (e - b <= leaf_size) {
+                    ranges[n++] = {b, e};
+                } else {
+                    const uint32_t m = split(src, b, e);
+                    ranges[n++] = {b, m};
+                    ranges[n++] = {m, e};
+                }
+            }
+        }
+
+        Node node;
+        size_t inner[width];
+        size_t inner_count = 0;
+        for (size_t l = 0; l < width; l++) {
+            const AABB<N, T> box = l < n ? range_bounds(src, ranges[l].first, ranges[l].second) : AABB<N, T>();
+            for (size_t a = 0; a < N; a++) {
+                node.lo[a][l] = box.lo[a];
+                node.hi[a][l] = box.hi[a];
+            }
+            if (l >= n) {
+                node.child[l] = empty;
+                node.count[l] = 0;
+            } else if (ranges[l].second - ranges[l].first <= leaf_size) {
+                node.child[l] = ranges[l].first;
+                node.count[l] = ranges[l].second - ranges[l].first;
+            } else {
+                node.count[l] = 0;
+                inner[inner_count++] = l;
+            }
+        }
+        const auto index = static_cast<uint32_t>(out.size());
+        out.push_back(node);
+
+        if (threads <= 1 || inner_count <= 1) {
+            for (size_t j = 0; j < inner_count; j++) {
+                const size_t l = inner[j];
+                const uint32_t child = build(out, src, ranges[l].first, ranges[l].second, 1);
+                out[index].child[l] = child;
+            }
+            return index;
+        }
+
+        // children on separate threads into their own arrays, then spliced behind this node
+        std::vector<Node> sub[width];
+        detail::parallel_chunks(inner_count, inner_count, [&](size_t j, size_t, size_t) {
+            const size_t l = inner[j];
+            build(sub[j], src, ranges[l].first, ranges[l].second, threads / inner_count);
+        });
+        for (size_t j = 0; j < inner_count; j++) {
+            const auto offset = static_cast<uint32_t>(out.size());
+            for (Node& s : sub[j]) {
+                for (size_t l = 0; l < width; l++) {
+                    if (s.count[l] == 0 && s.child[l] != empty) {
+                        s.child[l] += offset;
+                    }
+                }
+            }
+            out.insert(out.end(), sub[j].begin(), sub[j].end());
+            out[index].child[inner[j]] = offset;
+        }
+        return index;
+    }
+
+
+    std::vector<Node> nodes;
+    std::vector<uint32_t> ids;// original index of points[i]
+    std::vector<V> points;    // leaf order
+};
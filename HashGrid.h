@@ -0,0 +1,209 @@
+#pragma once
+
+
+#include <cstdint>
+
+#include <algorithm>
+#include <bit>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include "Vector.h"
+#include "morton.h"
+#include "parallel.h"
+
+
+enum class cell_hash : uint8_t {
+    multiplicative,// per lane odd multipliers folded with xor
+    morton         // lane bits interleaved in Z-order, neighboring cells stay close in the key
+};
+
+
+namespace detail {
+    // 2^64 / golden ratio, the top bits of key * golden index the table (Fibonacci hashing)
+    constexpr uint64_t golden = 0x9e3779b97f4a7c15;
+
+    template <cell_hash H, size_t N, integral T>
+    [[nodiscard]] constexpr uint64_t hash_cell(const Vector<N, T>& cell) noexcept {
+        const auto u = cell.template cast<uint64_t>();
+        return [&]<size_t... Is>(std::index_sequence<Is...>) {
+            if constexpr (H == cell_hash::morton) {
+                return (interleave<N, Is>(u[Is]) | ...) * golden;
+            } else {
+                constexpr uint64_t primes[]{0x8da6b343, 0xd8163841, 0xcb1ab31f, 0x9e3779b1};
+                const auto m = u * Vector<N, uint64_t>{primes[Is]...};
+                return (m[Is] ^ ...) * golden;
+            }
+        }(std::make_index_sequence<N>{});
+    }
+}// namespace detail
+
+
+// uniform grid over integral cell coordinates, mapping every cell to the ids inserted into it
+// open addressing with linear probing, the ids of a cell are contiguous so a lookup touches one slot and one run of ids
+template <size_t N, detail::integral T, cell_hash Hash = cell_hash::multiplicative>
+class HashGrid {
+    using V = Vector<N, T>;
+
+public:
+    HashGrid() = default;
+
+    explicit HashGrid(std::span<const V> cells) {
+        insert(cells);
+    }
+
+
+    // number of inserted ids
+    [[nodiscard]] size_t size() const noexcept {
+        return slot_of.size();
+    }
+
+    // number of distinct cells
+    [[nodiscard]] size_t cell_count() const noexcept {
+        return cells;
+    }
+
+    void clear() noexcept {
+        std::fill(slots.begin(), slots.end(), Slot{});
+        ids.clear();
+        slot_of.clear();
+        cells = 0;
+    }
+
+
+    // inserts ids size() .. size() + new_cells.size() - 1, the i-th one into new_cells[i]
+    // the ids are regrouped by cell afterwards, so a batch costs O(size()) no matter how small it is
+    void insert(std::span<const V> new_cells) {
+        slot_of.reserve(slot_of.size() + new_cells.size());
+        for_blocks(new_cells, [&](const V& cell, uint64_t h) {
+            if ((cells + 1) * 2 > slots.size()) {
+                grow();
+            }
+            size_t s = h >> shift;
+            for (; slots[s].count && !(slots[s].key == cell).all(); s = (s + 1) & (slots.size() - 1)) {}
+            if (!slots[s].count++) {
+                slots[s].key = cell;
+                cells++;
+            }
+            slot_of.push_back(static_cast<uint32_t>(s));
+        });
+
+        // counting sort of all ids by slot
+        uint32_t begin = 0;
+        for (Slot& slot : slots) {
+            slot.begin = begin;
+            begin += slot.count;
+        }
+        std::vector<uint32_t> cursor(slots.size());
+        std::transform(slots.begin(), slots.end(), cursor.begin(), [](const Slot& slot) { return slot.begin; });
+        ids.resize(slot_of.size());
+        for (size_t i = 0; i < slot_of.size(); i++) {
+            ids[cursor[slot_of[i]]++] = static_cast<uint32_t>(i);
+        }
+    }
+
+
+    // ids inserted into cell, in insertion order
+    [[nodiscard]] std::span<const uint32_t> find(const V& cell) const noexcept {
+        return find(cell, detail::hash_cell<Hash>(cell));
+    }
+
+    // hashes and prefetches a block of cells before probing any of them, so the table misses overlap
+    void find(std::span<const V> queries, std::span<std::span<const uint32_t>> out, size_t threads = 1) const noexcept {
+        detail::parallel_chunks(queries.size(), detail::chunk_count(queries.size(), threads, 4096), [&](size_t, size_t begin, size_t end) {
+            size_t i = begin;
+            for_blocks(queries.subspan(begin, end - begin), [&](const V& cell, uint64_t h) { out[i++] = find(cell, h); });
+        });
+    }
+
+    // calls f(id) for every id in the 3^N cells around cell, cell included
+    void for_each_neighbor(const V& cell, const auto& f) const {
+        constexpr size_t count = [] {
+            size_t n = 1;
+            for (size_t a = 0; a < N; a++) {
+                n *= 3;
+            }
+            return n;
+        }();
+        for (size_t k = 0; k < count; k++) {
+            V c = cell;
+            for (size_t a = 0, r = k; a < N; a++, r /= 3) {
+                c[a] = static_cast<T>(c[a] + static_cast<int>(r % 3) - 1);
+            }
+            for (const uint32_t id : find(c)) {
+                f(id);
+            }
+        }
+    }
+
+private:
+    static constexpr size_t block = 64;
+
+
+    struct Slot {
+        V key;
+        uint32_t begin = 0;
+        uint32_t count = 0;// 0 marks a free slot
+    };
+
+
+    std::span<const uint32_t> find(const V& cell, uint64_t h) const noexcept {
+        if (slots.empty()) {
+            return {};
+        }
+        for (size_t s = h >> shift; slots[s].count; s = (s + 1) & (slots.size() - 1)) {
+            if ((slots[s].key == cell).all()) {
+                return std::span(ids).subspan(slots[s].begin, slots[s].count);
+            }
+        }
+        return {};
+    }
+
+    // f(cell, hash) for every cell, hashing a block ahead of probing it
+    void for_blocks(std::span<const V> keys, const auto& f) const {
+        uint64_t h[block];
+        for (size_t b = 0; b < keys.size(); b += block) {
+            const size_t n = std::min(block, keys.size() - b);
+            for (size_t i = 0; i < n; i++) {
+                h[i] = detail::hash_cell<Hash>(keys[b + i]);
+            }
+#if defined(__GNUC__)
+            if (!slots.empty()) {
+                for (size_t i = 0; i < n; i++) {
+                    __builtin_prefetch(&slots[h[i] >> shift]);
+                }
+            }
+#endif
+            for (size_t i = 0; i < n; i++) {
+                f(keys[b + i], h[i]);
+            }
+        }
+    }
+
+    // doubles the table and moves every cell, ids follow their cell through slot_of
+    void grow() {
+        std::vector<Slot> old = std::exchange(slots, std::vector<Slot>(std::max<size_t>(slots.size() * 2, 16)));
+        shift = 64 - std::countr_zero(slots.size());
+        std::vector<uint32_t> moved(old.size());
+        for (size_t o = 0; o < old.size(); o++) {
+            if (!old[o].count) {
+                continue;
+            }
+            size_t s = detail::hash_cell<Hash>(old[o].key) >> shift;
+            for (; slots[s].count; s = (s + 1) & (slots.size() - 1)) {}
+            slots[s] = old[o];
+            moved[o] = static_cast<uint32_t>(s);
+        }
+        for (uint32_t& s : slot_of) {
+            s = moved[s];
+        }
+    }
+
+
+    std::vector<Slot> slots;
+    int shift = 64;
+    std::vector<uint32_t> ids;    // grouped by cell
+    std::vector<uint32_t> slot_of;// slot of every id
+    size_t cells = 0;
+};
@@ -0,0 +1,153 @@
+#pragma once
+
+
+#include <cmath>
+
+#include <span>
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+#include "Vector.h"
+#include "geometric.h"
+
+
+// q = w + xi + yj + zk, stored as Vector<4, T>(x, y, z, w) so that xyz and w keep addressing the vector and scalar parts
+template <detail::floating T>
+struct Quaternion : Vector<4, T> {
+    using Vector<4, T>::operator=;
+    using Vector<4, T>::operator*=;
+
+
+    // identity
+    constexpr Quaternion() noexcept : Vector<4, T>(T{0}, T{0}, T{0}, T{1}) {}
+
+    constexpr Quaternion(T x, T y, T z, T w) noexcept : Vector<4, T>(x, y, z, w) {}
+
+    constexpr explicit Quaternion(const Vector<4, T>& v) noexcept : Vector<4, T>(v) {}
+
+    // rotation by angle radians around a unit axis
+    [[nodiscard]] static Quaternion from_axis_angle(const Vector<3, T>& axis, T angle) noexcept {
+        const T s = std::sin(angle / 2);
+        return Quaternion(axis.x * s, axis.y * s, axis.z * s, std::cos(angle / 2));
+    }
+
+
+    constexpr Quaternion& operator*=(const Quaternion& rhs) noexcept {
+        return *this = *this * rhs;
+    }
+
+
+    [[nodiscard]] constexpr Quaternion conjugate() const noexcept {
+        return Quaternion(-this->x, -this->y, -this->z, this->w);
+    }
+
+    [[nodiscard]] constexpr Quaternion inverse() const noexcept {
+        return Quaternion(conjugate() / dot(*this, *this));
+    }
+
+    [[nodiscard]] constexpr Quaternion normalized() const noexcept {
+        return Quaternion(normalize(*this));
+    }
+
+    // rotates v by this unit quaternion: v + w * t + u x t, t = 2 * u x v
+    [[nodiscard]] constexpr Vector<3, T> rotate(const Vector<3, T>& v) const noexcept {
+        const auto t = cross(this->xyz, v) * T{2};
+        return v + t * this->w + cross(this->xyz, t);
+    }
+};
+
+
+namespace detail {
+#if defined(__SSE2__)
+    inline __m128 fmadd(__m128 a, __m128 b, __m128 c) noexcept {
+#if defined(__FMA__)
+        return _mm_fmadd_ps(a, b, c);
+#else
+        return _mm_add_ps(_mm_mul_ps(a, b), c);
+#endif
+    }
+
+    inline __m128 fnmadd(__m128 a, __m128 b, __m128 c) noexcept {
+#if defined(__FMA__)
+        return _mm_fnmadd_ps(a, b, c);
+#else
+        return _mm_sub_ps(c, _mm_mul_ps(a, b));
+#endif
+    }
+
+    // same lane pattern as the generic operator* below
+    inline Quaternion<float> quaternion_mul(const Quaternion<float>& lhs, const Quaternion<float>& rhs) noexcept {
+        const __m128 a = _mm_loadu_ps(lhs.data);
+        const __m128 b = _mm_loadu_ps(rhs.data);
+        const __m128 w_sign = _mm_castsi128_ps(_mm_setr_epi32(0, 0, 0, static_cast<int>(0x80000000u)));
+        __m128 t = _mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(0, 2, 1, 0)), _mm_shuffle_ps(b, b, _MM_SHUFFLE(0, 3, 3, 3)));
+        t = fmadd(_mm_shuffle_ps(a, a, _MM_SHUFFLE(1, 0, 2, 1)), _mm_shuffle_ps(b, b, _MM_SHUFFLE(1, 1, 0, 2)), t);
+        __m128 r = fmadd(_mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 3, 3, 3)), b, _mm_xor_ps(t, w_sign));
+        r = fnmadd(_mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 1, 0, 2)), _mm_shuffle_ps(b, b, _MM_SHUFFLE(2, 0, 2, 1)), r);
+        Quaternion<float> q;
+        _mm_storeu_ps(q.data, r);
+        return q;
+    }
+#endif
+}// namespace detail
+
+
+// Hamilton product
+template <detail::floating T>
+[[nodiscard]] constexpr Quaternion<T> operator*(const Quaternion<T>& lhs, const Quaternion<T>& rhs) noexcept {
+#if defined(__SSE2__)
+    if !consteval {
+        if constexpr (std::is_same_v<T, float>) {
+            return detail::quaternion_mul(lhs, rhs);
+        }
+    }
+#endif
+    const Vector<4, T> w_sign(T{1}, T{1}, T{1}, T{-1});
+    return Quaternion<T>(lhs.wwww * rhs + (lhs.xyzx * rhs.wwwx + lhs.yzxy * rhs.zxyy) * w_sign - lhs.zxyz * rhs.yzxz);
+}
+
+
+template <detail::floating T>
+[[nodiscard]] constexpr Quaternion<T> nlerp(const Quaternion<T>& a, const Quaternion<T>& b, T t) noexcept {
+    const T s = dot(a, b) < 0 ? -t : t;// take the shorter arc
+    return Quaternion<T>(a * (T{1} - t) + b * s).normalized();
+}
+
+template <detail::floating T>
+[[nodiscard]] constexpr Quaternion<T> slerp(const Quaternion<T>& a, const Quaternion<T>& b, T t) noexcept {
+    T d = dot(a, b);
+    const T sign = d < 0 ? T{-1} : T{1};
+    d *= sign;
+    if (d > T{0.9995}) {// sin(theta) vanishes, nlerp is indistinguishable
+        return nlerp(a, b, t);
+    }
+    const T theta = std::acos(d);
+    const T s = std::sin(theta);
+    return Quaternion<T>(a * (std::sin((T{1} - t) * theta) / s) + b * (sign * std::sin(t * theta) / s));
+}
+
+
+// batched versions, out must hold at least in.size() / a.size() elements
+// the quaternion is expanded to a rotation matrix once so that each vector costs three multiply-adds per lane
+template <detail::floating T>
+constexpr void rotate(const Quaternion<T>& q, std::type_identity_t<std::span<const Vector<3, T>>> in, std::span<Vector<3, T>> out) noexcept {
+    const T xx = q.x * q.x, yy = q.y * q.y, zz = q.z * q.z;
+    const T xy = q.x * q.y, xz = q.x * q.z, yz = q.y * q.z;
+    const T wx = q.w * q.x, wy = q.w * q.y, wz = q.w * q.z;
+    const Vector<3, T> c0(T{1} - 2 * (yy + zz), 2 * (xy + wz), 2 * (xz - wy));
+    const Vector<3, T> c1(2 * (xy - wz), T{1} - 2 * (xx + zz), 2 * (yz + wx));
+    const Vector<3, T> c2(2 * (xz + wy), 2 * (yz - wx), T{1} - 2 * (xx + yy));
+    for (size_t i = 0; i < in.size(); i++) {
+        const Vector<3, T> v = in[i];
+        out[i] = c0 * v.x + c1 * v.y + c2 * v.z;
+    }
+}
+
+template <detail::floating T>
+constexpr void slerp(std::type_identity_t<std::span<const Quaternion<T>>> a, std::type_identity_t<std::span<const Quaternion<T>>> b, T t, std::span<Quaternion<T>> out) noexcept {
+    for (size_t i = 0; i < a.size(); i++) {
+        out[i] = slerp(a[i], b[i], t);
+    }
+}
@@ -3,11 +3,19 @@
 
 #include <cmath>
 
+#include <algorithm>
 #include <concepts>
 #include <iostream>
+#include <type_traits>
 
 #include "type_helper.h"
 
+#if defined(VECTOR_INSTRUMENT)
+#include "instrument.h"
+#else
+#define VECTOR_INSTRUMENT_COUNT(kind, dim, ...)
+#endif
+
 
 template <size_t N, detail::numeric T>
 struct Vector;
@@ -17,7 +25,7 @@ namespace detail {
     struct Base;
 
     template <typename T>
-    concept integral_element_constraint = std::derived_from<T, Base> && integral<typename T::element_type>;
+    concept integral_element_constraint = std::derived_from<T, Base> && integral_or_lanes<typename T::element_type>;
 
     template <typename Other, typename Self>
     concept rhs_constraint = std::derived_from<Other, Base> && Other::dim == Self::dim || numeric<Other>;
@@ -46,7 +54,7 @@ namespace detail {
 
         // bitwise operators
         template <typename Self>
-            requires integral<typename Self::element_type>
+            requires integral_or_lanes<typename Self::element_type>
         [[nodiscard]] constexpr auto operator~(this const Self& self) noexcept {
             return self.unary_func([](auto e) -> typename Self::element_type { return ~e; });
         }
@@ -58,144 +66,147 @@ namespace detail {
 
 
         // other unary functions
-        template <numeric T>
-        [[nodiscard]] constexpr auto cast(this const auto& self) noexcept {
-            return self.unary_func([](auto e) -> T { return e; });
+        // math functions are looked up next to the element type as well as in std, so element types can provide their own
+        template <numeric T, typename Self>
+        [[nodiscard]] constexpr auto cast(this const Self& self) noexcept {
+            using C = cast_type_t<typename Self::element_type, T>;
+            return self.unary_func([](auto e) -> C { return static_cast<C>(e); });
         }
 
         template <typename Self>
         [[nodiscard]] constexpr auto abs(this const Self& self) noexcept {
-            return self.unary_func([](auto e) -> typename Self::element_type { return std::abs(e); });
+            return self.unary_func([](auto e) -> typename Self::element_type { using std::abs; return abs(e); });
         }
 
         [[nodiscard]] constexpr auto sqrt(this const auto& self) noexcept {
-            return self.unary_func([](auto e) { return std::sqrt(e); });
+            return self.unary_func([](auto e) { using std::sqrt; return sqrt(e); });
         }
 
         [[nodiscard]] constexpr auto cbrt(this const auto& self) noexcept {
-            return self.unary_func([](auto e) { return std::cbrt(e); });
+            return self.unary_func([](auto e) { using std::cbrt; return cbrt(e); });
         }
 
         [[nodiscard]] constexpr auto exp(this const auto& self) noexcept {
-            return self.unary_func([](auto e) { return std::exp(e); });
+            return self.unary_func([](auto e) { using std::exp; return exp(e); });
         }
 
         [[nodiscard]] constexpr auto exp2(this const auto& self) noexcept {
-            return self.unary_func([](auto e) { return std::exp2(e); });
+            return self.unary_func([](auto e) { using std::exp2; return exp2(e); });
         }
 
         [[nodiscard]] constexpr auto expm1(this const auto& self) noexcept {
-            return self.unary_func([](auto e) { return std::expm1(e); });
+            return self.unary_func([](auto e) { using std::expm1; return expm1(e); });
         }
 
         [[nodiscard]] constexpr auto log(this const auto& self) noexcept {
-            return self.unary_func([](auto e) { return std::log(e); });
+            return self.unary_func([](auto e) { using std::log; return log(e); });
         }
 
         [[nodiscard]] constexpr auto log10(this const auto& self) noexcept {
-            return self.unary_func([](auto e) { return std::log10(e); });
+            return self.unary_func([](auto e) { using std::log10; return log10(e); });
         }
 
         [[nodiscard]] constexpr auto log2(this const auto& self) noexcept {
-            return self.unary_func([](auto e) { return std::log2(e); });
+            return self.unary_func([](auto e) { using std::log2; return log2(e); });
         }
 
         [[nodiscard]] constexpr auto log1p(this const auto& self) noexcept {
-            return self.unary_func([](auto e) { return std::log1p(e); });
+            return self.unary_func([](auto e) { using std::log1p; return log1p(e); });
         }
 
         [[nodiscard]] constexpr auto sin(this const auto& self) noexcept {
-            return self.unary_func([](auto e) { return std::sin(e); });
+            return self.unary_func([](auto e) { using std::sin; return sin(e); });
         }
 
         [[nodiscard]] constexpr auto cos(this const auto& self) noexcept {
-            return self.unary_func([](auto e) { return std::cos(e); });
+            return self.unary_func([](auto e) { using std::cos; return cos(e); });
         }
 
         [[nodiscard]] constexpr auto tan(this const auto& self) noexcept {
-            return self.unary_func([](auto e) { return std::tan(e); });
+            return self.unary_func([](auto e) { using std::tan; return tan(e); });
         }
 
         [[nodiscard]] constexpr auto asin(this const auto& self) noexcept {
-            return self.unary_func([](auto e) { return std::asin(e); });
+            return self.unary_func([](auto e) { using std::asin; return asin(e); });
         }
 
         [[nodiscard]] constexpr auto acos(this const auto& self) noexcept {
-            return self.unary_func([](auto e) { return std::acos(e); });
+            return self.unary_func([](auto e) { using std::acos; return acos(e); });
         }
 
         [[nodiscard]] constexpr auto atan(this const auto& self) noexcept {
-            return self.unary_func([](auto e) { return std::atan(e); });
+            return self.unary_func([](auto e) { using std::atan; return atan(e); });
         }
 
         [[nodiscard]] constexpr auto sinh(this const auto& self) noexcept {
-            return self.unary_func([](auto e) { return std::sinh(e); });
+            return self.unary_func([](auto e) { using std::sinh; return sinh(e); });
         }
 
         [[nodiscard]] constexpr auto cosh(this const auto& self) noexcept {
-            return self.unary_func([](auto e) { return std::cosh(e); });
+            return self.unary_func([](auto e) { using std::cosh; return cosh(e); });
         }
 
         [[nodiscard]] constexpr auto tanh(this const auto& self) noexcept {
-            return self.unary_func([](auto e) { return std::tanh(e); });
+            return self.unary_func([](auto e) { using std::tanh; return tanh(e); });
         }
 
         [[nodiscard]] constexpr auto asinh(this const auto& self) noexcept {
-            return self.unary_func([](auto e) { return std::asinh(e); });
+            return self.unary_func([](auto e) { using std::asinh; return asinh(e); });
         }
 
         [[nodiscard]] constexpr auto acosh(this const auto& self) noexcept {
-            return self.unary_func([](auto e) { return std::acosh(e); });
+            return self.unary_func([](auto e) { using std::acosh; return acosh(e); });
         }
 
         [[nodiscard]] constexpr auto atanh(this const auto& self) noexcept {
-            return self.unary_func([](auto e) { return std::atanh(e); });
+            return self.unary_func([](auto e) { using std::atanh; return atanh(e); });
         }
 
         [[nodiscard]] constexpr auto erf(this const auto& self) noexcept {
-            return self.unary_func([](auto e) { return std::erf(e); });
+            return self.unary_func([](auto e) { using std::erf; return erf(e); });
         }
 
         [[nodiscard]] constexpr auto erfc(this const auto& self) noexcept {
-            return self.unary_func([](auto e) { return std::erfc(e); });
+            return self.unary_func([](auto e) { using std::erfc; return erfc(e); });
         }
 
         [[nodiscard]] constexpr auto tgamma(this const auto& self) noexcept {
-            return self.unary_func([](auto e) { return std::tgamma(e); });
+            return self.unary_func([](auto e) { using std::tgamma; return tgamma(e); });
         }
 
         [[nodiscard]] constexpr auto lgamma(this const auto& self) noexcept {
-            return self.unary_func([](auto e) { return std::lgamma(e); });
+            return self.unary_func([](auto e) { using std::lgamma; return lgamma(e); });
         }
 
         [[nodiscard]] constexpr auto ceil(this const auto& self) noexcept {
-            return self.unary_func([](auto e) { return std::ceil(e); });
+            return self.unary_func([](auto e) { using std::ceil; return ceil(e); });
         }
 
         [[nodiscard]] constexpr auto floor(this const auto& self) noexcept {
-            return self.unary_func([](auto e) { return std::floor(e); });
+            return self.unary_func([](auto e) { using std::floor; return floor(e); });
         }
 
         [[nodiscard]] constexpr auto trunc(this const auto& self) noexcept {
-            return self.unary_func([](auto e) { return std::trunc(e); });
+            return self.unary_func([](auto e) { using std::trunc; return trunc(e); });
         }
 
         [[nodiscard]] constexpr auto round(this const auto& self) noexcept {
-            return self.unary_func([](auto e) { return std::round(e); });
+            return self.unary_func([](auto e) { using std::round; return round(e); });
         }
 
 
+        // over lane groups one mask per lane, see packet.h
         template <typename Self>
-        [[nodiscard]] constexpr bool any(this const Self& self) noexcept {
+        [[nodiscard]] constexpr auto any(this const Self& self) noexcept {
             return [&]<size_t... Is>(std::index_sequence<Is...>) {
-                return (... || self[Is]);
+                return (false || ... || self[Is]);
             }(std::make_index_sequence<Self::dim>{});
         }
 
         template <typename Self>
-        [[nodiscard]] constexpr bool all(this const Self& self) noexcept {
+        [[nodiscard]] constexpr auto all(this const Self& self) noexcept {
             return [&]<size_t... Is>(std::index_sequence<Is...>) {
-                return (... && self[Is]);
+                return (true && ... && self[Is]);
             }(std::make_index_sequence<Self::dim>{});
         }
 
@@ -207,6 +218,7 @@ namespace detail {
 
         template <size_t... Is>
         constexpr auto unary_func(this const auto& self, const auto& op, std::index_sequence<Is...>) noexcept {
+            VECTOR_INSTRUMENT_COUNT(unary, sizeof...(Is), std::remove_cvref_t<decltype(op(self[0]))>);
             return Vector{op(self[Is])...};
         }
     };
@@ -320,8 +332,10 @@ namespace detail {
         constexpr void inplace_func(this Self& self, const Other& v, const auto& op, std::index_sequence<Is...>) noexcept {
             using LT = typename Self::element_type;
             using RT = typename Other::element_type;
+            VECTOR_INSTRUMENT_COUNT(inplace, sizeof...(Is), LT);
             if constexpr (std::is_same_v<LT, RT>) {
                 if (self.data == v.data) {
+                    VECTOR_INSTRUMENT_COUNT(inplace_alias, sizeof...(Is), LT);
                     RT tmp[]{v[Is]...};
                     (..., op(self[Is], tmp[Is]));
                     return;
@@ -337,16 +351,18 @@ namespace detail {
 
         template <size_t... Is>
         constexpr void inplace_func(this auto& self, numeric auto e, const auto& op, std::index_sequence<Is...>) noexcept {
+            VECTOR_INSTRUMENT_COUNT(inplace_scalar, sizeof...(Is), typename std::remove_cvref_t<decltype(self)>::element_type);
             (..., op(self[Is], e));
         }
 
         template <typename Self>
         constexpr void inplace_func(this Self& self, const auto& op) noexcept {
-            self.unary_func(op, std::make_index_sequence<Self::dim>{});
+            self.inplace_func(op, std::make_index_sequence<Self::dim>{});
         }
 
         template <size_t... Is>
         constexpr void inplace_func(this auto& self, const auto& op, std::index_sequence<Is...>) noexcept {
+            VECTOR_INSTRUMENT_COUNT(inplace_unary, sizeof...(Is), typename std::remove_cvref_t<decltype(self)>::element_type);
             (..., op(self[Is]));
         }
     };
@@ -355,16 +371,33 @@ namespace detail {
     template <std::derived_from<Base> L, std::derived_from<Base> R, size_t... Is>
         requires(L::dim == R::dim)
     [[nodiscard]] constexpr auto binary_func(const L& lhs, const R& rhs, const auto& op, std::index_sequence<Is...>) noexcept {
+        VECTOR_INSTRUMENT_COUNT(binary, sizeof...(Is), std::remove_cvref_t<decltype(op(lhs[0], rhs[0]))>);
         return Vector{op(lhs[Is], rhs[Is])...};
     }
 
+    // under promotion::glsl a scalar becomes the element type before the operation, unless it is floating and the elements are not
+    template <promotion P, typename E, numeric S>
+    [[nodiscard]] constexpr auto scalar_operand(S e) noexcept {
+        if constexpr (P == promotion::glsl && ((integral<E> && integral<S>) || (floating<E> && (integral<S> || floating<S>)))) {
+            return static_cast<E>(e);
+        } else {
+            return e;
+        }
+    }
+
     template <std::derived_from<Base> L, size_t... Is>
-    [[nodiscard]] constexpr auto binary_func(const L& lhs, numeric auto e, const auto& op, std::index_sequence<Is...>) noexcept {
+    [[nodiscard]] constexpr auto binary_func(const L& lhs, numeric auto scalar, const auto& op, std::index_sequence<Is...>) noexcept {
+        using E = typename L::element_type;
+        const auto e = scalar_operand<promotion_v<E, decltype(scalar)>, E>(scalar);
+        VECTOR_INSTRUMENT_COUNT(binary_scalar, sizeof...(Is), std::remove_cvref_t<decltype(op(lhs[0], e))>);
         return Vector{op(lhs[Is], e)...};
     }
 
     template <std::derived_from<Base> R, size_t... Is>
-    [[nodiscard]] constexpr auto binary_func(numeric auto e, const R& rhs, const auto& op, std::index_sequence<Is...>) noexcept {
+    [[nodiscard]] constexpr auto binary_func(numeric auto scalar, const R& rhs, const auto& op, std::index_sequence<Is...>) noexcept {
+        using E = typename R::element_type;
+        const auto e = scalar_operand<promotion_v<decltype(scalar), E>, E>(scalar);
+        VECTOR_INSTRUMENT_COUNT(binary_scalar, sizeof...(Is), std::remove_cvref_t<decltype(op(e, rhs[0]))>);
         return Vector{op(e, rhs[Is])...};
     }
 
@@ -592,18 +625,21 @@ namespace detail {
         template <std::same_as<T>... Ts>
             requires(sizeof...(Ts) == N)
         constexpr VectorBase(Ts... es) noexcept {
-            new (data()) T[]{es...};
+            const T buffer[]{es...};
+            std::copy_n(buffer, N, data());
         }
 
         constexpr explicit VectorBase(const T* const buffer) noexcept {
             std::copy_n(buffer, N, data());
         }
 
-        constexpr VectorBase(const VectorBase& v) noexcept : VectorBase(v.data()) {}
+        constexpr VectorBase(const VectorBase&) noexcept = default;// the union in Vector is copied bitwise
 
         template <size_t M, size_t... Is>
             requires(sizeof...(Is) == N)
-        constexpr VectorBase(const Swizzle<M, T, Is...>& v) noexcept : VectorBase(v.data[Is]...) {}
+        constexpr VectorBase(const Swizzle<M, T, Is...>& v) noexcept : VectorBase(v.data[Is]...) {
+            VECTOR_INSTRUMENT_COUNT(swizzle_to_vector, N, T);
+        }
 
 
         template <typename Self>
@@ -632,8 +668,9 @@ struct Vector<2, T> : detail::VectorBase<2, T>, detail::MutableBase {
     using detail::VectorBase<2, T>::VectorBase;
 
 
+    // user-provided because the Swizzle members of the union assign element-wise, copy construction stays trivial
     constexpr auto& operator=(const Vector& v) noexcept {
-        if (this != &v) {
+        if (this != &v) {// std::copy_n does not allow overlapping ranges
             std::copy_n(v.data, dim, data);
         }
         return *this;
@@ -699,8 +736,9 @@ struct Vector<3, T> : detail::VectorBase<3, T>, detail::MutableBase {
     constexpr Vector(const V& v, T e) noexcept : data{v[0], v[1], e} {}
 
 
+    // user-provided because the Swizzle members of the union assign element-wise, copy construction stays trivial
     constexpr auto& operator=(const Vector& v) noexcept {
-        if (this != &v) {
+        if (this != &v) {// std::copy_n does not allow overlapping ranges
             std::copy_n(v.data, dim, data);
         }
         return *this;
@@ -877,8 +915,9 @@ struct Vector<4, T> : detail::VectorBase<4, T>, detail::MutableBase {
     constexpr Vector(const V& v, const W& w) noexcept : data{v[0], v[1], w[0], w[1]} {}
 
 
+    // user-provided because the Swizzle members of the union assign element-wise, copy construction stays trivial
     constexpr auto& operator=(const Vector& v) noexcept {
-        if (this != &v) {
+        if (this != &v) {// std::copy_n does not allow overlapping ranges
             std::copy_n(v.data, dim, data);
         }
         return *this;
@@ -1277,3 +1316,15 @@ Vector(V, T, T) -> Vector<2 + V::dim, T>;
 template <std::derived_from<detail::Base> V, std::derived_from<detail::Base> W>
     requires(V::dim == 2 && W::dim == 2 && std::is_same_v<typename V::element_type, typename W::element_type>)
 Vector(V, W) -> Vector<4, typename V::element_type>;
+
+
+namespace detail {
+    // copy construction and destruction are bitwise, so arrays can be copied or relocated with memcpy
+    template <typename V>
+    concept bitwise_copyable = std::is_trivially_copy_constructible_v<V> && std::is_trivially_destructible_v<V>;
+}// namespace detail
+
+
+static_assert(detail::bitwise_copyable<Vector<2, float>> && detail::bitwise_copyable<Vector<3, float>> && detail::bitwise_copyable<Vector<4, float>>);
+static_assert(detail::bitwise_copyable<Vector<2, double>> && detail::bitwise_copyable<Vector<3, int32_t>> && detail::bitwise_copyable<Vector<4, uint8_t>>);
+static_assert(detail::bitwise_copyable<Vector<3, bool>> && detail::bitwise_copyable<detail::Swizzle<3, float, 2, 1, 0>>);
@@ -0,0 +1,159 @@
+#pragma once
+
+
+#include <cmath>
+#include <cstdint>
+
+#include <span>
+#include <vector>
+
+#include "Vector.h"
+#include "dispatch.h"
+#include "parallel.h"
+
+
+// how sum() adds up a span, all lane-wise
+// kahan and neumaier carry a running compensation per lane, float storage gets close to double accuracy
+// pairwise halves the range recursively, error grows with log n instead of n at the cost of no extra state
+// the compensations are algebraically zero, so none of this survives -ffast-math / -fassociative-math
+enum class summation : uint8_t {
+    naive,
+    kahan,
+    neumaier,// Kahan-Babuska, also exact when an added value is larger than the running sum
+    pairwise
+};
+
+
+template <size_t N, detail::floating T, summation S = summation::neumaier>
+    requires(S == summation::kahan || S == summation::neumaier)
+struct CompensatedSum {
+    Vector<N, T> sum, c;// c is the rounding error still to be added to sum
+
+
+    constexpr CompensatedSum& operator+=(const Vector<N, T>& v) noexcept {
+        for (size_t i = 0; i < N; i++) {
+            if constexpr (S == summation::kahan) {
+                const T y = v[i] + c[i];
+                const T t = sum[i] + y;
+                c[i] = y - (t - sum[i]);
+                sum[i] = t;
+            } else {
+                const T t = sum[i] + v[i];
+                c[i] += std::abs(sum[i]) >= std::abs(v[i]) ? (sum[i] - t) + v[i] : (v[i] - t) + sum[i];
+                sum[i] = t;
+            }
+        }
+        return *this;
+    }
+
+    constexpr CompensatedSum& operator+=(const CompensatedSum& other) noexcept {
+        *this += other.sum;
+        if constexpr (S == summation::kahan) {
+            return *this += other.c;
+        } else {
+            c += other.c;
+            return *this;
+        }
+    }
+
+    [[nodiscard]] constexpr Vector<N, T> result() const noexcept {
+        return sum + c;
+    }
+};
+
+
+namespace detail {
+    constexpr size_t sum_block = 1 << 14;
+    constexpr size_t pairwise_leaf = 128;
+
+    template <typename T>
+    constexpr bool compensated = false;
+
+    template <size_t N, floating T, summation S>
+    constexpr bool compensated<CompensatedSum<N, T, S>> = true;
+
+    // running state of a summation: the compensated accumulator, or just the partial sum
+    template <summation S, size_t N, floating T>
+    struct sum_state {
+        using type = Vector<N, T>;
+    };
+
+    template <summation S, size_t N, floating T>
+        requires(S == summation::kahan || S == summation::neumaier)
+    struct sum_state<S, N, T> {
+        using type = CompensatedSum<N, T, S>;
+    };
+
+    template <summation S, size_t N, floating T>
+    using sum_state_t = typename sum_state<S, N, T>::type;
+
+
+    // four interleaved chains per block hide the add latency, always combined as (0 + 1) + (2 + 3)
+    template <summation S, size_t N, floating T>
+    [[nodiscard]] constexpr sum_state_t<S, N, T> block_sum(const Vector<N, T>* v, size_t n) noexcept {
+        if constexpr (S == summation::pairwise) {
+            if (n > pairwise_leaf) {
+                const size_t half = n / 2;
+                return block_sum<S>(v, half) + block_sum<S>(v + half, n - half);
+            }
+        }
+        sum_state_t<S, N, T> acc[4]{};
+        size_t i = 0;
+        for (; i + 4 <= n; i += 4) {
+            acc[0] += v[i];
+            acc[1] += v[i + 1];
+            acc[2] += v[i + 2];
+            acc[3] += v[i + 3];
+        }
+        for (; i < n; i++) {
+            acc[0] += v[i];
+        }
+        acc[0] += acc[1];
+        acc[2] += acc[3];
+        return acc[0] += acc[2];
+    }
+
+    // folds the per-block states, as a balanced tree for pairwise and in block order otherwise
+    template <summation S, typename State>
+    [[nodiscard]] constexpr State combine_sums(const State* s, size_t n) noexcept {
+        if constexpr (S == summation::pairwise) {
+            if (n > 1) {
+                const size_t half = n / 2;
+                return combine_sums<S>(s, half) + combine_sums<S>(s + half, n - half);
+            }
+            return n ? s[0] : State{};
+        } else {
+            State acc{};
+            for (size_t i = 0; i < n; i++) {
+                acc += s[i];
+            }
+            return acc;
+        }
+    }
+
+    template <typename State>
+    [[nodiscard]] constexpr auto sum_result(const State& s) noexcept {
+        if constexpr (compensated<State>) {
+            return s.result();
+        } else {
+            return s;
+        }
+    }
+}// namespace detail
+
+
+// lane-wise sum of values, blocks of fixed size are summed on up to threads threads (0 = all hardware threads)
+// block boundaries and the combination order only depend on values.size(), so the result is the same for any thread count
+template <summation S = summation::neumaier, size_t N, detail::floating T>
+[[nodiscard]] Vector<N, T> sum(std::span<const Vector<N, T>> values, size_t threads = 1) {
+    if (values.size() <= detail::sum_block) {
+        detail::sum_state_t<S, N, T> state{};
+        detail::dispatch([&] { state = detail::block_sum<S>(values.data(), values.size()); });
+        return detail::sum_result(state);
+    }
+    std::vector<detail::sum_state_t<S, N, T>> partial((values.size() + detail::sum_block - 1) / detail::sum_block);
+    detail::parallel_blocks(values.size(), detail::sum_block, threads, [&](size_t b, size_t begin, size_t end) {
+        detail::dispatch([&] { partial[b] = detail::block_sum<S>(values.data() + begin, end - begin); });
+    });
+    return detail::sum_result(detail::combine_sums<S>(partial.data(), partial.size()));
+}
@@ -0,0 +1,306 @@
+#pragma once
+
+
+#include <algorithm>
+#include <iterator>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+#include "Vector.h"
+#include "dispatch.h"
+
+
+namespace detail {
+    // W Vectors stored component by component, one full register of lanes per component
+    template <size_t N, typename T, size_t W>
+    struct alignas(std::min<size_t>(W * sizeof(T), 64)) aosoa_block {
+        T lanes[N][W];
+    };
+
+
+    // x, y, z and w of an element, bound to its lanes in the block
+    template <size_t N, typename P>
+    struct aosoa_names;
+
+    template <typename P>
+    struct aosoa_names<2, P> {
+        P &x, &y;
+
+        aosoa_names(P* p, size_t stride) noexcept : x(p[0]), y(p[stride]) {}
+    };
+
+    template <typename P>
+    struct aosoa_names<3, P> {
+        P &x, &y, &z;
+
+        aosoa_names(P* p, size_t stride) noexcept : x(p[0]), y(p[stride]), z(p[2 * stride]) {}
+    };
+
+    template <typename P>
+    struct aosoa_names<4, P> {
+        P &x, &y, &z, &w;
+
+        aosoa_names(P* p, size_t stride) noexcept : x(p[0]), y(p[stride]), z(p[2 * stride]), w(p[3 * stride]) {}
+    };
+
+
+    // element of an AoSoA, usable wherever the library takes a Vector or a Swizzle: operators, geometric functions,
+    // x, y, z, w; swizzle members need contiguous lanes and are reached through the Vector, e.g. Vector(e).zyx
+    // like a reference it assigns through, also as the temporary returned by AoSoA::operator[]: a[i] += v
+    // P is T, or const T for elements of a const container, which cannot be assigned to
+    template <size_t N, typename P, size_t W>
+    struct aosoa_element : aosoa_names<N, P>, Base {
+        static constexpr size_t dim = N;
+        using element_type = std::remove_const_t<P>;
+
+
+        aosoa_element(P* p) noexcept : aosoa_names<N, P>(p, W), data(p) {}
+
+        aosoa_element(const aosoa_element&) noexcept = default;
+
+
+        const aosoa_element& operator=(const aosoa_element& other) const noexcept
+            requires(!std::is_const_v<P>) {
+            return inplace_func(other, [](auto& l, auto r) noexcept { l = r; });
+        }
+
+        const aosoa_element& operator=(const rhs_constraint<aosoa_element> auto& other) const noexcept
+            requires(!std::is_const_v<P>) {
+            return inplace_func(other, [](auto& l, auto r) noexcept { l = r; });
+        }
+
+        const aosoa_element& operator+=(const rhs_constraint<aosoa_element> auto& other) const noexcept
+            requires(!std::is_const_v<P>) {
+            return inplace_func(other, [](auto& l, auto r) noexcept { l += r; });
+        }
+
+        const aosoa_element& operator-=(const rhs_constraint<aosoa_element> auto& other) const noexcept
+            requires(!std::is_const_v<P>) {
+            return inplace_func(other, [](auto& l, auto r) noexcept { l -= r; });
+        }
+
+        const aosoa_element& operator*=(const rhs_constraint<aosoa_element> auto& other) const noexcept
+            requires(!std::is_const_v<P>) {
+            return inplace_func(other, [](auto& l, auto r) noexcept { l *= r; });
+        }
+
+        const aosoa_element& operator/=(const rhs_constraint<aosoa_element> auto& other) const noexcept
+            requires(!std::is_const_v<P>) {
+            return inplace_func(other, [](auto& l, auto r) noexcept { l /= r; });
+        }
+
+
+        [[nodiscard]] P& operator[](size_t i) const noexcept {
+            return data[i * W];
+        }
+
+        operator Vector<N, element_type>() const noexcept {
+            return [&]<size_t... Is>(std::index_sequence<Is...>) {
+                return Vector<N, element_type>{data[Is * W]...};
+            }(std::make_index_sequence<N>{});
+        }
+
+    private:
+        // the right-hand side is read completely first, it may be this element
+        template <typename V>
+        const aosoa_element& inplace_func(const V& other, const auto& op) const noexcept {
+            if constexpr (std::derived_from<V, Base>) {
+                typename V::element_type tmp[N];
+                for (size_t i = 0; i < N; i++) {
+                    tmp[i] = other[i];
+                }
+                for (size_t i = 0; i < N; i++) {
+                    op((*this)[i], tmp[i]);
+                }
+            } else {
+                for (size_t i = 0; i < N; i++) {
+                    op((*this)[i], other);
+                }
+            }
+            return *this;
+        }
+
+
+        P* data;
+    };
+
+
+    // input iterator handing out element proxies, enough for range-for and the std algorithms reading a range
+    template <size_t N, typename P, size_t W>
+    class aosoa_iterator {
+        using block = aosoa_block<N, std::remove_const_t<P>, W>;
+
+    public:
+        using value_type = Vector<N, std::remove_const_t<P>>;
+        using reference = aosoa_element<N, P, W>;
+        using difference_type = std::ptrdiff_t;
+        using iterator_category = std::input_iterator_tag;
+
+
+        aosoa_iterator() noexcept = default;
+
+        aosoa_iterator(std::conditional_t<std::is_const_v<P>, const block, block>* blocks, size_t i) noexcept : blocks(blocks), i(i) {}
+
+
+        [[nodiscard]] reference operator*() const noexcept {
+            return &blocks[i / W].lanes[0][i % W];
+        }
+
+        aosoa_iterator& operator++() noexcept {
+            i++;
+            return *this;
+        }
+
+        aosoa_iterator operator++(int) noexcept {
+            const auto tmp = *this;
+            i++;
+            return tmp;
+        }
+
+        [[nodiscard]] bool operator==(const aosoa_iterator& other) const noexcept {
+            return i == other.i;
+        }
+
+    private:
+        std::conditional_t<std::is_const_v<P>, const block, block>* blocks = nullptr;
+        size_t i = 0;
+    };
+}// namespace detail
+
+
+// array of structures of arrays: blocks of W Vectors with each component contiguous inside the block
+// a kernel touching all components of an element streams N full registers per block instead of gathering from
+// interleaved Vectors, while the components of one element stay within a cache line or two
+// the unused lanes of the last block are zero
+template <size_t N, detail::numeric T, size_t W = 8>
+    requires(N >= 2 && N <= 4 && (W == 8 || W == 16))
+class AoSoA {
+public:
+    using block = detail::aosoa_block<N, T, W>;
+    using value_type = Vector<N, T>;
+    using reference = detail::aosoa_element<N, T, W>;
+    using const_reference = detail::aosoa_element<N, const T, W>;
+    using iterator = detail::aosoa_iterator<N, T, W>;
+    using const_iterator = detail::aosoa_iterator<N, const T, W>;
+
+    static constexpr size_t width = W;
+
+
+    AoSoA() noexcept = default;
+
+    // zero-initialized
+    explicit AoSoA(size_t n) : storage((n + W - 1) / W), count(n) {}
+
+    explicit AoSoA(std::span<const Vector<N, T>> v) : AoSoA(v.size()) {
+        for (size_t i = 0; i < count; i++) {
+            (*this)[i] = v[i];
+        }
+    }
+
+
+    [[nodiscard]] reference operator[](size_t i) noexcept {
+        return &storage[i / W].lanes[0][i % W];
+    }
+
+    [[nodiscard]] const_reference operator[](size_t i) const noexcept {
+        return &storage[i / W].lanes[0][i % W];
+    }
+
+    [[nodiscard]] size_t size() const noexcept {
+        return count;
+    }
+
+    [[nodiscard]] bool empty() const noexcept {
+        return count == 0;
+    }
+
+    // new elements are zero
+    void resize(size_t n) {
+        if (n < count) {
+            // keeps the unused lanes of the last block zero
+            for (size_t i = n; i < std::min(count, (n + W - 1) / W * W); i++) {
+                (*this)[i] = T{};
+            }
+        }
+        storage.resize((n + W - 1) / W);
+        count = n;
+    }
+
+    void push_back(const Vector<N, T>& v) {
+        resize(count + 1);
+        (*this)[count - 1] = v;
+    }
+
+    void clear() noexcept {
+        storage.clear();
+        count = 0;
+    }
+
+
+    [[nodiscard]] std::span<block> blocks() noexcept {
+        return storage;
+    }
+
+    [[nodiscard]] std::span<const block> blocks() const noexcept {
+        return storage;
+    }
+
+    [[nodiscard]] iterator begin() noexcept {
+        return {storage.data(), 0};
+    }
+
+    [[nodiscard]] iterator end() noexcept {
+        return {storage.data(), count};
+    }
+
+    [[nodiscard]] const_iterator begin() const noexcept {
+        return {storage.data(), 0};
+    }
+
+    [[nodiscard]] const_iterator end() const noexcept {
+        return {storage.data(), count};
+    }
+
+    // out[i] = (*this)[i], out must hold at least size() elements
+    void copy_to(std::span<Vector<N, T>> out) const noexcept {
+        for (size_t i = 0; i < count; i++) {
+            out[i] = (*this)[i];
+        }
+    }
+
+private:
+    std::vector<block> storage;
+    size_t count = 0;
+};
+
+
+// out[i] = f(in[i]) block by block, f takes a Vector and returns a Vector or Swizzle, e.g. [](auto v) { return normalize(v); }
+// the lane loop over a full block has a constant trip count, so the compiler maps every Vector operation in f onto
+// whole component registers; the lanes past size() are skipped, so f never sees the zero padding
+// out is resized to in.size() and may be in
+template <size_t N, detail::numeric T, size_t M, detail::numeric U, size_t W, typename F>
+void block_map(const AoSoA<N, T, W>& in, AoSoA<M, U, W>& out, const F& f) {
+    out.resize(in.size());
+    const auto src = in.blocks();
+    const auto dst = out.blocks();
+    const size_t full = in.size() / W;
+    detail::dispatch([&] {
+        const auto lanes = [&](size_t b, auto count) {
+            for (size_t j = 0; j < count; j++) {
+                const Vector<M, U> r = f([&]<size_t... Is>(std::index_sequence<Is...>) {
+                    return Vector<N, T>{src[b].lanes[Is][j]...};
+                }(std::make_index_sequence<N>{}));
+                for (size_t i = 0; i < M; i++) {
+                    dst[b].lanes[i][j] = r[i];
+                }
+            }
+        };
+        for (size_t b = 0; b < full; b++) {
+            lanes(b, std::integral_constant<size_t, W>{});
+        }
+        if (full < src.size()) {
+            lanes(full, in.size() - full * W);
+        }
+    });
+}
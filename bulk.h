@@ -0,0 +1,65 @@
+#pragma once
+
+
+#include <cstddef>
+#include <cstring>
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <memory>
+#include <span>
+
+#include "Vector.h"
+
+
+namespace detail {
+    // below this many Vectors the plain loops are at least as fast as the library calls
+    constexpr size_t bulk_threshold = 32;
+
+    // every byte of the object representation zero, so memset reproduces v (-0.0 does not count)
+    // compared byte-wise, element types such as Interval<double> or Lanes<float, 16> are wider than any integer
+    template <size_t N, numeric T>
+    [[nodiscard]] constexpr bool is_zero_bits(const Vector<N, T>& v) noexcept {
+        return [&]<size_t... Is>(std::index_sequence<Is...>) {
+            using bytes = std::array<std::byte, sizeof(T)>;
+            return (... && (std::bit_cast<bytes>(v[Is]) == bytes{}));
+        }(std::make_index_sequence<N>{});
+    }
+}// namespace detail
+
+
+// dst[i] = v, large zero fills become memset and the rest doubling memcpy
+// dst may also be raw storage, Vector being trivially copy constructible and trivially destructible
+template <size_t N, detail::numeric T>
+    requires detail::bitwise_copyable<Vector<N, T>>
+constexpr void bulk_fill(std::span<Vector<N, T>> dst, const std::type_identity_t<Vector<N, T>>& v) noexcept {
+    if consteval {
+        std::fill(dst.begin(), dst.end(), v);
+    } else {
+        if (dst.size() < detail::bulk_threshold) {
+            std::uninitialized_fill(dst.begin(), dst.end(), v);
+        } else if (detail::is_zero_bits(v)) {
+            std::memset(static_cast<void*>(dst.data()), 0, dst.size_bytes());
+        } else {
+            const Vector<N, T> tmp = v;// v may live in dst
+            std::memcpy(static_cast<void*>(dst.data()), &tmp, sizeof(tmp));
+            for (size_t done = 1; done < dst.size();) {
+                const size_t n = std::min(done, dst.size() - done);
+                std::memcpy(static_cast<void*>(dst.data() + done), dst.data(), n * sizeof(tmp));
+                done += n;
+            }
+        }
+    }
+}
+
+// dst[i] = src[i] for i < src.size(), the ranges may overlap
+template <size_t N, detail::numeric T>
+    requires detail::bitwise_copyable<Vector<N, T>>
+constexpr void bulk_copy(std::type_identity_t<std::span<const Vector<N, T>>> src, std::span<Vector<N, T>> dst) noexcept {
+    if consteval {
+        std::copy(src.begin(), src.end(), dst.begin());
+    } else {
+        std::memmove(static_cast<void*>(dst.data()), src.data(), src.size_bytes());
+    }
+}
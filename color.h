@@ -0,0 +1,174 @@
+#pragma once
+
+
+#include <cmath>
+#include <cstdint>
+
+#include <algorithm>
+#include <bit>
+#include <span>
+
+#include "Vector.h"
+#include "dispatch.h"
+#include "geometric.h"
+
+
+namespace detail {
+    // log2 and exp2 from the exponent bits and a polynomial over the mantissa, no tables and no branches so row loops vectorize
+    // both are within a few float ulps for positive normal inputs, the sRGB curves stay within 5e-7 of the exact ones
+    [[nodiscard]] constexpr float fast_log2(float x) noexcept {
+        const auto bits = std::bit_cast<uint32_t>(x);
+        const auto e = static_cast<float>(static_cast<int32_t>(bits >> 23) - 127);
+        const float t = std::bit_cast<float>((bits & 0x007fffff) | 0x3f800000) - 1;
+        float p = 7.395402123e-03f;
+        for (const float c : {-4.194500886e-02f, 1.118320738e-01f, -1.962389518e-01f, 2.752212123e-01f, -3.582990696e-01f, 4.806788896e-01f, -7.213395131e-01f, 1.442694992e+00f}) {
+            p = p * t + c;
+        }
+        return e + p * t;
+    }
+
+    [[nodiscard]] constexpr float fast_exp2(float y) noexcept {
+        y = std::clamp(y, -126.0f, 127.0f);
+        const auto i = static_cast<int32_t>(y) - (y < static_cast<float>(static_cast<int32_t>(y)));// floor
+        const float f = y - static_cast<float>(i);
+        float p = 2.186578478e-04f;
+        for (const float c : {1.239133184e-03f, 9.684186310e-03f, 5.548063020e-02f, 2.402304544e-01f, 6.931469328e-01f, 1.000000003e+00f}) {
+            p = p * f + c;
+        }
+        return std::bit_cast<float>(static_cast<uint32_t>(i + 127) << 23) * p;
+    }
+
+    template <floating T>
+    [[nodiscard]] constexpr T pow_positive(T x, T e) noexcept {
+        if constexpr (std::same_as<T, float>) {
+            return fast_exp2(e * fast_log2(x));
+        } else {
+            return std::pow(x, e);
+        }
+    }
+
+
+    // IEC 61966-2-1, both branches are computed and one selected so the kernels stay branch free
+    template <floating T>
+    [[nodiscard]] constexpr T srgb_to_linear(T c) noexcept {
+        const T curve = pow_positive(std::max((c + T(0.055)) / T(1.055), T(0.055) / T(1.055)), T(2.4));
+        return c <= T(0.04045) ? c / T(12.92) : curve;
+    }
+
+    template <floating T>
+    [[nodiscard]] constexpr T linear_to_srgb(T c) noexcept {
+        const T curve = T(1.055) * pow_positive(std::max(c, T(0.0031308)), 1 / T(2.4)) - T(0.055);
+        return c <= T(0.0031308) ? c * T(12.92) : curve;
+    }
+
+    template <size_t N, floating T>
+        requires(N == 3 || N == 4)
+    [[nodiscard]] constexpr Vector<N, T> color_map(const Vector<N, T>& c, const auto& f) noexcept {
+        Vector<N, T> out = c;
+        out.rgb = Vector<3, T>{f(c.r), f(c.g), f(c.b)};
+        return out;
+    }
+}// namespace detail
+
+
+// rgb transfer functions, alpha is linear in both encodings and passes through
+template <size_t N, detail::floating T>
+    requires(N == 3 || N == 4)
+[[nodiscard]] constexpr Vector<N, T> srgb_to_linear(const Vector<N, T>& c) noexcept {
+    return detail::color_map(c, [](T e) { return detail::srgb_to_linear(e); });
+}
+
+template <size_t N, detail::floating T>
+    requires(N == 3 || N == 4)
+[[nodiscard]] constexpr Vector<N, T> linear_to_srgb(const Vector<N, T>& c) noexcept {
+    return detail::color_map(c, [](T e) { return detail::linear_to_srgb(e); });
+}
+
+
+// r in the lowest byte, i.e. the bytes R, G, B, A in memory on little endian
+[[nodiscard]] constexpr Vector<4, float> unpack_rgba8(uint32_t p) noexcept {
+    return Vector<4, uint32_t>{p, p >> 8, p >> 16, p >> 24}.cast<uint8_t>().cast<float>() / 255.0f;
+}
+
+// clamps to [0, 1] and rounds to nearest
+[[nodiscard]] constexpr uint32_t pack_rgba8(const Vector<4, float>& c) noexcept {
+    const auto q = [&]<size_t... Is>(std::index_sequence<Is...>) {
+        return Vector<4, uint32_t>{static_cast<uint32_t>(std::clamp(c[Is], 0.0f, 1.0f) * 255.0f + 0.5f)...};
+    }(std::make_index_sequence<4>{});
+    return q.r | q.g << 8 | q.b << 16 | q.a << 24;
+}
+
+
+template <detail::floating T>
+[[nodiscard]] constexpr Vector<4, T> premultiply(const Vector<4, T>& c) noexcept {
+    return {Vector<3, T>(c.rgb) * c.a, c.a};
+}
+
+// fully transparent colors come back as transparent black
+template <detail::floating T>
+[[nodiscard]] constexpr Vector<4, T> unpremultiply(const Vector<4, T>& c) noexcept {
+    return {Vector<3, T>(c.rgb) * (c.a > 0 ? 1 / c.a : T{0}), c.a};
+}
+
+// relative luminance of linear Rec. 709 / sRGB primaries
+template <size_t N, detail::floating T>
+    requires(N == 3 || N == 4)
+[[nodiscard]] constexpr T luminance(const Vector<N, T>& c) noexcept {
+    return dot(Vector<3, T>(c.rgb), Vector<3, T>{T(0.2126), T(0.7152), T(0.0722)});
+}
+
+
+// row kernels, in place where input and output have the same type, compiled for the detected instruction set
+inline void unpack_rgba8(std::span<const uint32_t> in, std::span<Vector<4, float>> out) noexcept {
+    detail::dispatch([&] { std::transform(in.begin(), in.end(), out.begin(), [](uint32_t p) { return unpack_rgba8(p); }); });
+}
+
+inline void pack_rgba8(std::span<const Vector<4, float>> in, std::span<uint32_t> out) noexcept {
+    detail::dispatch([&] { std::transform(in.begin(), in.end(), out.begin(), [](const Vector<4, float>& c) { return pack_rgba8(c); }); });
+}
+
+// packed sRGB8 to linear float and back, the usual ends of an image pipeline
+inline void decode_srgb8(std::span<const uint32_t> in, std::span<Vector<4, float>> out) noexcept {
+    detail::dispatch([&] { std::transform(in.begin(), in.end(), out.begin(), [](uint32_t p) { return srgb_to_linear(unpack_rgba8(p)); }); });
+}
+
+inline void encode_srgb8(std::span<const Vector<4, float>> in, std::span<uint32_t> out) noexcept {
+    detail::dispatch([&] { std::transform(in.begin(), in.end(), out.begin(), [](const Vector<4, float>& c) { return pack_rgba8(linear_to_srgb(c)); }); });
+}
+
+template <size_t N, detail::floating T>
+void srgb_to_linear(std::span<Vector<N, T>> row) noexcept {
+    detail::dispatch([&] {
+        for (Vector<N, T>& c : row) {
+            c = srgb_to_linear(c);
+        }
+    });
+}
+
+template <size_t N, detail::floating T>
+void linear_to_srgb(std::span<Vector<N, T>> row) noexcept {
+    detail::dispatch([&] {
+        for (Vector<N, T>& c : row) {
+            c = linear_to_srgb(c);
+        }
+    });
+}
+
+template <detail::floating T>
+void premultiply(std::span<Vector<4, T>> row) noexcept {
+    for (Vector<4, T>& c : row) {
+        c = premultiply(c);
+    }
+}
+
+template <detail::floating T>
+void unpremultiply(std::span<Vector<4, T>> row) noexcept {
+    for (Vector<4, T>& c : row) {
+        c = unpremultiply(c);
+    }
+}
+
+template <size_t N, detail::floating T>
+void luminance(std::span<const Vector<N, T>> row, std::span<T> out) noexcept {
+    std::transform(row.begin(), row.end(), out.begin(), [](const Vector<N, T>& c) { return luminance(c); });
+}
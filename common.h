@@ -0,0 +1,39 @@
+#pragma once
+
+
+#include "Vector.h"
+
+
+// GLSL common functions, element-wise with the same operand rules and promotion as the binary operators
+// min/max select like minps/maxps: the second operand is returned when the comparison is false, NaN included
+
+template <typename L, typename R>
+    requires detail::binary_compatible<L, R>
+[[nodiscard]] constexpr auto min(const L& lhs, const R& rhs) noexcept {
+    return detail::binary_func(lhs, rhs, [](auto l, auto r) -> detail::common_type_t<decltype(l), decltype(r)> {
+        using C = detail::common_type_t<decltype(l), decltype(r)>;
+        return static_cast<C>(l) < static_cast<C>(r) ? l : r;
+    });
+}
+
+template <typename L, typename R>
+    requires detail::binary_compatible<L, R>
+[[nodiscard]] constexpr auto max(const L& lhs, const R& rhs) noexcept {
+    return detail::binary_func(lhs, rhs, [](auto l, auto r) -> detail::common_type_t<decltype(l), decltype(r)> {
+        using C = detail::common_type_t<decltype(l), decltype(r)>;
+        return static_cast<C>(l) > static_cast<C>(r) ? l : r;
+    });
+}
+
+template <std::derived_from<detail::Base> V, typename Lo, typename Hi>
+    requires detail::binary_compatible<V, Lo> && detail::binary_compatible<V, Hi>
+[[nodiscard]] constexpr auto clamp(const V& v, const Lo& lo, const Hi& hi) noexcept {
+    return min(max(v, lo), hi);
+}
+
+// x * (1 - a) + y * a
+template <std::derived_from<detail::Base> X, std::derived_from<detail::Base> Y, typename A>
+    requires(X::dim == Y::dim) && detail::binary_compatible<X, A>
+[[nodiscard]] constexpr auto mix(const X& x, const Y& y, const A& a) noexcept {
+    return x + (y - x) * a;
+}
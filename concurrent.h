@@ -0,0 +1,162 @@
+#pragma once
+
+
+#include <cstdint>
+
+#include <atomic>
+#include <bit>
+#include <optional>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+#include "Vector.h"
+#include "bulk.h"
+#include "dispatch.h"
+#include "parallel.h"
+
+
+// lock-free updates of a Vector shared between threads
+// every lane is updated atomically on its own; a Vector<2, float> whose lanes sit in one aligned 64-bit word is
+// updated with a single compare-exchange instead, so readers never see half of an add
+template <size_t N, typename T>
+    requires(detail::integral<T> || detail::floating<T>)
+class AtomicVectorRef {
+public:
+    explicit AtomicVectorRef(Vector<N, T>& v) noexcept : v(v) {}
+
+
+    // relaxed by default: concurrent adds commute and the results are usually read after the workers are joined
+    void add(const Vector<N, T>& d, std::memory_order order = std::memory_order_relaxed) const noexcept {
+        if constexpr (packable) {
+            if (auto word = packed()) {
+                uint64_t old = word->load(std::memory_order_relaxed);
+                while (!word->compare_exchange_weak(old, pack(unpack(old) + d), order, std::memory_order_relaxed)) {}
+                return;
+            }
+        }
+        for (size_t i = 0; i < N; i++) {
+            // floating lanes are a compare-exchange loop, integral lanes a single locked add
+            std::atomic_ref<T>(v[i]).fetch_add(d[i], order);
+        }
+    }
+
+    [[nodiscard]] Vector<N, T> load(std::memory_order order = std::memory_order_seq_cst) const noexcept {
+        if constexpr (packable) {
+            if (auto word = packed()) {
+                return unpack(word->load(order));
+            }
+        }
+        return [&]<size_t... Is>(std::index_sequence<Is...>) {
+            return Vector<N, T>{std::atomic_ref<T>(v[Is]).load(order)...};
+        }(std::make_index_sequence<N>{});
+    }
+
+    void store(const Vector<N, T>& d, std::memory_order order = std::memory_order_seq_cst) const noexcept {
+        if constexpr (packable) {
+            if (auto word = packed()) {
+                word->store(pack(d), order);
+                return;
+            }
+        }
+        for (size_t i = 0; i < N; i++) {
+            std::atomic_ref<T>(v[i]).store(d[i], order);
+        }
+    }
+
+    const AtomicVectorRef& operator+=(const Vector<N, T>& d) const noexcept {
+        add(d);
+        return *this;
+    }
+
+private:
+    static constexpr bool packable = N == 2 && sizeof(T) == 4;
+
+    // Vector's lanes start after its empty bases, so the 8-byte alignment of the pair is only known at run time
+    [[nodiscard]] std::optional<std::atomic_ref<uint64_t>> packed() const noexcept
+        requires packable {
+        if (reinterpret_cast<uintptr_t>(&v[0]) % std::atomic_ref<uint64_t>::required_alignment == 0) {
+            return std::atomic_ref<uint64_t>(*reinterpret_cast<uint64_t*>(&v[0]));
+        }
+        return std::nullopt;
+    }
+
+    [[nodiscard]] static uint64_t pack(const Vector<N, T>& d) noexcept
+        requires packable {
+        return std::bit_cast<uint32_t>(d[0]) | uint64_t{std::bit_cast<uint32_t>(d[1])} << 32;
+    }
+
+    [[nodiscard]] static Vector<N, T> unpack(uint64_t w) noexcept
+        requires packable {
+        return {std::bit_cast<T>(static_cast<uint32_t>(w)), std::bit_cast<T>(static_cast<uint32_t>(w >> 32))};
+    }
+
+
+    Vector<N, T>& v;
+};
+
+
+// one private copy of the target per worker, added to without any synchronisation and summed afterwards
+// costs shards * size Vectors; for sparse updates into a large target AtomicVectorRef is the cheaper choice
+template <size_t N, detail::numeric T>
+class ShardedAccumulator {
+public:
+    ShardedAccumulator(size_t size, size_t shards) : size(size), shards(shards), data(size * shards) {}
+
+
+    [[nodiscard]] std::span<Vector<N, T>> shard(size_t s) noexcept {
+        return std::span(data).subspan(s * size, size);
+    }
+
+    [[nodiscard]] size_t shard_count() const noexcept {
+        return shards;
+    }
+
+    // out[i] += shard 0 [i] + shard 1 [i] + ..., in shard order for every thread count (0 = all hardware threads)
+    void merge_into(std::span<Vector<N, T>> out, size_t threads = 1) const {
+        detail::parallel_blocks(size, merge_block, threads, [&](size_t, size_t begin, size_t end) {
+            detail::dispatch([&] {
+                for (size_t s = 0; s < shards; s++) {
+                    const Vector<N, T>* in = data.data() + s * size;
+                    for (size_t i = begin; i < end; i++) {
+                        out[i] += in[i];
+                    }
+                }
+            });
+        });
+    }
+
+    void clear() noexcept {
+        bulk_fill(std::span(data), Vector<N, T>{});
+    }
+
+private:
+    static constexpr size_t merge_block = 1 << 12;
+
+
+    size_t size, shards;
+    std::vector<Vector<N, T>> data;
+};
+
+
+// target[idx[i]] += values[i] on up to threads threads (0 = all hardware threads), duplicate indices allowed
+// every worker splats its range into its own shard, the shards are then merged in parallel
+// the ranges follow the thread count, so floating sums may differ in the last bits between thread counts
+template <size_t N, detail::numeric T>
+void scatter_add(std::span<Vector<N, T>> target, std::span<const uint32_t> idx, std::type_identity_t<std::span<const Vector<N, T>>> values, size_t threads = 1) {
+    const size_t chunks = detail::chunk_count(idx.size(), threads, 1 << 12);
+    if (chunks <= 1) {
+        for (size_t i = 0; i < idx.size(); i++) {
+            target[idx[i]] += values[i];
+        }
+        return;
+    }
+    ShardedAccumulator<N, T> acc(target.size(), chunks);
+    detail::parallel_chunks(idx.size(), chunks, [&](size_t c, size_t begin, size_t end) {
+        const auto shard = acc.shard(c);
+        for (size_t i = begin; i < end; i++) {
+            shard[idx[i]] += values[i];
+        }
+    });
+    acc.merge_into(target, threads);
+}
@@ -0,0 +1,406 @@
+#pragma once
+
+
+#include <cstdint>
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <ostream>
+#include <limits>
+#include <span>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include "Vector.h"
+#include "aosoa.h"
+#include "dispatch.h"
+#include "packet.h"
+#include "random.h"
+#include "sort.h"
+#include "swizzle.h"
+
+
+// differential checking of the batch and SIMD paths against the scalar Vector operators
+// a case is a random operator chain run over random Vectors by the plain operators (the reference), batch_map under
+// the active instruction set, packet_map over Lanes and block_map over an AoSoA; swizzles are compared against
+// RuntimeSwizzle, and the mixed-type promotion and aliasing rules of the operators against element-wise formulas
+// results are compared bit for bit (NaNs of either sign are equal), floating results may be allowed max_ulp;
+// the paths only round identically when built with -ffp-contract=off, see dispatch.h
+// cases are drawn from a byte string, so a fuzzer can steer them, and from a Philox stream once it runs out;
+// tests/differential.cpp runs them from seeds, tests/fuzz_differential.cpp from libFuzzer
+
+
+// outcome of one or more differential runs
+struct DiffReport {
+    size_t programs = 0;// operator chains
+    size_t cases = 0;   // inputs run through them
+    size_t mismatches = 0;
+    uint64_t max_ulp = 0;// largest floating difference seen, including tolerated ones
+    std::string first;   // the first mismatch: type, path, case, lane and both values
+
+
+    void merge(const DiffReport& other) {
+        if (first.empty()) {
+            first = other.first;
+        }
+        programs += other.programs;
+        cases += other.cases;
+        mismatches += other.mismatches;
+        max_ulp = std::max(max_ulp, other.max_ulp);
+    }
+
+    friend std::ostream& operator<<(std::ostream& os, const DiffReport& r) {
+        os << r.programs << " programs, " << r.cases << " cases, " << r.mismatches << " mismatches, max " << r.max_ulp << " ulp\n";
+        if (!r.first.empty()) {
+            os << "first: " << r.first << "\n";
+        }
+        return os;
+    }
+};
+
+
+// distance in units in the last place, 0 for two NaNs and the largest value for a NaN against a number
+// integers are compared by their difference
+template <typename T>
+    requires(detail::integral<T> || detail::floating<T>)
+[[nodiscard]] constexpr uint64_t ulp_distance(T a, T b) noexcept {
+    if constexpr (detail::floating<T>) {
+        if (a != a || b != b) {
+            return a != a && b != b ? 0 : std::numeric_limits<uint64_t>::max();
+        }
+    }
+    const uint64_t x = detail::ordered_bits(a), y = detail::ordered_bits(b);
+    return x > y ? x - y : y - x;
+}
+
+
+namespace detail {
+    template <typename T>
+    constexpr std::string_view diff_type_name = std::is_same_v<T, int8_t>     ? "int8_t"
+                                                : std::is_same_v<T, int16_t>  ? "int16_t"
+                                                : std::is_same_v<T, int32_t>  ? "int32_t"
+                                                : std::is_same_v<T, int64_t>  ? "int64_t"
+                                                : std::is_same_v<T, uint8_t>  ? "uint8_t"
+                                                : std::is_same_v<T, uint16_t> ? "uint16_t"
+                                                : std::is_same_v<T, uint32_t> ? "uint32_t"
+                                                : std::is_same_v<T, uint64_t> ? "uint64_t"
+                                                : std::is_same_v<T, float>    ? "float"
+                                                                              : "double";
+
+    // the input bytes first, then a Philox stream
+    class diff_bytes {
+    public:
+        diff_bytes(std::span<const uint8_t> data, uint64_t seed) noexcept : data(data), rng(seed) {}
+
+
+        uint8_t byte() noexcept {
+            return offset < data.size() ? data[offset++] : static_cast<uint8_t>(rng());
+        }
+
+        template <typename U>
+        U bits() noexcept {
+            U u = 0;
+            for (size_t i = 0; i < sizeof(U); i++) {
+                u = static_cast<U>(u << 4 << 4 | byte());
+            }
+            return u;
+        }
+
+    private:
+        std::span<const uint8_t> data;
+        size_t offset = 0;
+        Philox rng;
+    };
+
+
+    // integer operations that can overflow are only generated where the result is defined: narrow types compute in
+    // int and wrap on conversion, unsigned types of at least int's width wrap, wide signed types get small values
+    template <typename T>
+    constexpr bool diff_multiplies = floating<T> || sizeof(T) == 1 || std::is_same_v<T, int16_t> || (std::is_unsigned_v<T> && sizeof(T) >= 4);
+
+    template <typename T>
+    constexpr bool diff_small = std::is_signed_v<T> && integral<T> && sizeof(T) >= 4;
+
+    template <typename T>
+    T diff_value(diff_bytes& in) noexcept {
+        if constexpr (floating<T>) {
+            using limits = std::numeric_limits<T>;
+            constexpr T specials[]{0, -T{0}, 1, -1, limits::infinity(), -limits::infinity(), limits::quiet_NaN(),
+                                   limits::min(), limits::denorm_min(), limits::max(), limits::epsilon()};
+            switch (in.byte() % 8) {
+                case 0:
+                    return specials[in.byte() % std::size(specials)];
+                case 1:
+                    return std::bit_cast<T>(in.bits<unsigned_of_size<sizeof(T)>>());
+                default:
+                    return (static_cast<T>(in.bits<uint32_t>()) * T{0x1p-31} - 1) * std::ldexp(T{1}, in.byte() % 16 - 8);
+            }
+        } else if constexpr (diff_small<T>) {
+            constexpr int64_t limit = int64_t{1} << (sizeof(T) * 4 - 5);
+            return static_cast<T>(static_cast<int64_t>(in.bits<uint64_t>() % (2 * limit + 1)) - limit);
+        } else {
+            return std::bit_cast<T>(in.bits<unsigned_of_size<sizeof(T)>>());
+        }
+    }
+
+
+    enum class diff_op : uint8_t {
+        add,
+        sub,
+        mul,
+        div,
+        scale,
+        swizzle,
+        abs,
+        sqrt,
+        count
+    };
+
+    constexpr const char* diff_op_names[]{"add", "sub", "mul", "div", "scale", "swizzle", "abs", "sqrt"};
+
+    template <typename T>
+    [[nodiscard]] constexpr bool diff_allows(diff_op op) noexcept {
+        switch (op) {
+            case diff_op::mul:
+            case diff_op::scale:
+                return diff_multiplies<T>;
+            case diff_op::div:
+            case diff_op::sqrt:
+                return floating<T>;
+            case diff_op::abs:
+                return std::is_signed_v<T>;
+            default:
+                return true;
+        }
+    }
+
+
+    // v = v op constant, at most 8 steps; the step count keeps the small wide signed values from overflowing
+    template <size_t N, typename T>
+    struct diff_program {
+        struct step {
+            diff_op op;
+            uint8_t pattern[N];
+            T scalar;
+        };
+
+        std::array<step, 8> steps;
+        size_t size = 0;
+        Vector<N, T> constant;
+
+
+        explicit diff_program(diff_bytes& in) noexcept {
+            size = in.byte() % (steps.size() + 1);
+            for (size_t s = 0; s < size; s++) {
+                step& st = steps[s];
+                st.op = static_cast<diff_op>(in.byte() % static_cast<size_t>(diff_op::count));
+                if (!diff_allows<T>(st.op)) {
+                    st.op = diff_op::add;
+                }
+                for (size_t i = 0; i < N; i++) {
+                    st.pattern[i] = static_cast<uint8_t>(in.byte() % N);
+                }
+                st.scalar = diff_value<T>(in);
+            }
+            for (size_t i = 0; i < N; i++) {
+                constant[i] = diff_value<T>(in);
+            }
+        }
+
+        [[nodiscard]] std::string describe() const {
+            std::string s;
+            for (size_t i = 0; i < size; i++) {
+                s += s.empty() ? "" : " ";
+                s += diff_op_names[static_cast<size_t>(steps[i].op)];
+            }
+            return s.empty() ? "identity" : s;
+        }
+
+
+        // V is Vector<N, T> or a Packet of it, written once like user code
+        template <typename V>
+        [[nodiscard]] V operator()(V v) const noexcept {
+            const V c = [&]<size_t... Is>(std::index_sequence<Is...>) {
+                return V{typename V::element_type(constant[Is])...};
+            }(std::make_index_sequence<N>{});
+            for (size_t s = 0; s < size; s++) {
+                const step& st = steps[s];
+                switch (st.op) {
+                    case diff_op::add:
+                        v = v + c;
+                        break;
+                    case diff_op::sub:
+                        v = c - v;
+                        break;
+                    case diff_op::swizzle:
+                        v = [&]<size_t... Is>(std::index_sequence<Is...>) {
+                            return V{v[st.pattern[Is]]...};
+                        }(std::make_index_sequence<N>{});
+                        break;
+                    default:
+                        if constexpr (diff_multiplies<T>) {
+                            if (st.op == diff_op::mul) {
+                                v = v * c;
+                            } else if (st.op == diff_op::scale) {
+                                v = v * st.scalar;
+                            }
+                        }
+                        if constexpr (floating<T>) {
+                            if (st.op == diff_op::div) {
+                                v = v / c;
+                            } else if (st.op == diff_op::sqrt) {
+                                v = v.sqrt();
+                            }
+                        }
+                        if constexpr (std::is_signed_v<T>) {
+                            if (st.op == diff_op::abs) {
+                                v = v.abs();
+                            }
+                        }
+                }
+            }
+            return v;
+        }
+    };
+
+
+    template <size_t N, typename T>
+    void diff_compare(DiffReport& report, uint64_t max_ulp, std::string_view path, const auto& what, size_t i, const Vector<N, T>& ref, const Vector<N, T>& got) {
+        for (size_t k = 0; k < N; k++) {
+            const uint64_t ulp = ulp_distance(ref[k], got[k]);
+            if constexpr (floating<T>) {
+                if (ulp != std::numeric_limits<uint64_t>::max()) {
+                    report.max_ulp = std::max(report.max_ulp, ulp);
+                }
+            }
+            if (ulp > (floating<T> ? max_ulp : 0)) {
+                if (report.mismatches++ == 0) {
+                    std::ostringstream os;
+                    os << "Vector<" << N << ", " << diff_type_name<T> << "> " << path << " [" << what() << "] element " << i
+                       << " lane " << k << ": expected " << +ref[k] << ", got " << +got[k] << " (" << ulp << " ulp)";
+                    report.first = os.str();
+                }
+            }
+        }
+    }
+
+
+    // promotion and aliasing rules of the operators, spelled out lane by lane
+    template <size_t N, typename T, typename R>
+    void diff_semantics(DiffReport& report, diff_bytes& in, std::string_view path) {
+        using C = common_type_t<T, R>;
+        Vector<N, T> a;
+        Vector<N, R> b;
+        Vector<N, C> expected;
+        for (size_t k = 0; k < N; k++) {
+            a[k] = diff_value<T>(in);
+            b[k] = diff_value<R>(in);
+            expected[k] = static_cast<C>(static_cast<C>(a[k]) + static_cast<C>(b[k]));
+        }
+        static_assert(std::is_same_v<decltype(a + b), Vector<N, C>>);
+        diff_compare(report, 0, path, [] { return "a + b"; }, 0, expected, a + b);
+
+        // the right-hand side aliases the target and has to be read completely first
+        if constexpr (N >= 3) {
+            Vector<N, T> w = a;
+            w.xyz = w.zxy;
+            const Vector<N, T> ref = a;
+            Vector<N, T> r = a;
+            r[0] = ref[2];
+            r[1] = ref[0];
+            r[2] = ref[1];
+            diff_compare(report, 0, path, [] { return "xyz = zxy"; }, 0, r, w);
+        }
+    }
+
+
+    // one program run over inputs random Vectors by every path
+    template <size_t N, typename T>
+    void diff_case(DiffReport& report, diff_bytes& in, size_t inputs, uint64_t max_ulp) {
+        const diff_program<N, T> program(in);
+        const auto what = [&] { return program.describe(); };
+
+        std::vector<Vector<N, T>> values(inputs), expected(inputs), got(inputs);
+        for (auto& v : values) {
+            for (size_t k = 0; k < N; k++) {
+                v[k] = diff_value<T>(in);
+            }
+        }
+        const std::span<const Vector<N, T>> src(values);
+        for (size_t i = 0; i < inputs; i++) {
+            expected[i] = program(values[i]);
+        }
+
+        batch_map(src, std::span(got), program);
+        for (size_t i = 0; i < inputs; i++) {
+            diff_compare(report, max_ulp, std::string("batch_map/") + std::string(isa_name(active_isa())), what, i, expected[i], got[i]);
+        }
+
+        packet_map(src, std::span(got), program);
+        for (size_t i = 0; i < inputs; i++) {
+            diff_compare(report, max_ulp, "packet_map", what, i, expected[i], got[i]);
+        }
+
+        AoSoA<N, T> blocked(src);
+        block_map(blocked, blocked, program);
+        blocked.copy_to(got);
+        for (size_t i = 0; i < inputs; i++) {
+            diff_compare(report, max_ulp, "block_map", what, i, expected[i], got[i]);
+        }
+
+        // patterns that do not parse for N, such as a w for Vector<3, T> or mixed letter sets, are skipped
+        char letters[N];
+        for (size_t k = 0; k < N; k++) {
+            letters[k] = "xyzwrgbauv"[in.byte() % 10];
+        }
+        const std::string_view pattern(letters, N);
+        if (const auto swizzle = RuntimeSwizzle<N>::parse(pattern)) {
+            (*swizzle)(src, std::span(got));
+            for (size_t i = 0; i < inputs; i++) {
+                Vector<N, T> ref;
+                for (size_t k = 0; k < N; k++) {
+                    ref[k] = values[i][(*swizzle)[k]];
+                }
+                diff_compare(report, 0, "RuntimeSwizzle", [&] { return pattern; }, i, ref, got[i]);
+            }
+        }
+
+        diff_semantics<N, T, double>(report, in, "promotion");
+        diff_semantics<N, T, int32_t>(report, in, "promotion");
+
+        report.programs++;
+        report.cases += inputs;
+    }
+}// namespace detail
+
+
+// programs random operator chains for Vector<N, T>, each run over inputs random Vectors,
+// drawn from data and then from the Philox stream seed
+template <size_t N, typename T>
+    requires(detail::integral<T> || detail::floating<T>) && (!std::is_same_v<T, bool>)
+[[nodiscard]] DiffReport differential_check(std::span<const uint8_t> data, uint64_t seed, size_t programs = 16, size_t inputs = 37, uint64_t max_ulp = 0) {
+    DiffReport report;
+    detail::diff_bytes in(data, seed);
+    for (size_t p = 0; p < programs; p++) {
+        detail::diff_case<N, T>(report, in, inputs, max_ulp);
+    }
+    return report;
+}
+
+// every dimension and integral or floating element type, each from its own part of the Philox stream
+[[nodiscard]] inline DiffReport differential_check_all(std::span<const uint8_t> data, uint64_t seed, size_t programs = 16, size_t inputs = 37, uint64_t max_ulp = 0) {
+    DiffReport report;
+    uint64_t stream = seed;
+    const auto types = [&]<size_t N, typename... Ts>() {
+        (..., report.merge(differential_check<N, Ts>(data, stream++, programs, inputs, max_ulp)));
+    };
+    [&]<size_t... Ns>(std::index_sequence<Ns...>) {
+        (..., types.template operator()<Ns + 2, int8_t, int16_t, int32_t, int64_t, uint8_t, uint16_t, uint32_t, uint64_t, float, double>());
+    }(std::make_index_sequence<3>{});
+    return report;
+}
+
@@ -0,0 +1,177 @@
+#pragma once
+
+
+#include <cstdint>
+#include <cstdlib>
+
+#include <algorithm>
+#include <span>
+#include <string_view>
+
+#include "Vector.h"
+
+
+// one binary, several instruction sets: the batch kernels are compiled once per level through the target attribute
+// and the level is picked on first use from cpuid, VECTOR_ISA=sse2|avx2|avx512 lowers it to test every path on one machine
+// the kernels are plain loops that the compiler vectorizes for each level (best at -O3)
+// avx2 and avx512 have FMA and gcc contracts a * b + c by default in C++, so by default those levels may round
+// differently from sse2; kernels whose bits must not depend on the machine, such as the deterministic reductions,
+// run unfused: no level contracts, also when the whole program is built with -mfma, only an explicit std::fma fuses
+enum class isa : uint8_t {
+    sse2,
+    avx2,
+    avx512
+};
+
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+    #define VECTOR_DISPATCH_X86
+#endif
+
+
+// gcc contracts the callees inlined into a function by that function's mode, clang only within one expression
+#if defined(__GNUC__) && !defined(__clang__)
+    #define VECTOR_UNFUSED gnu::optimize("fp-contract=off"), gnu::flatten
+#elif defined(__clang__)
+    #define VECTOR_UNFUSED gnu::flatten
+#else
+    #define VECTOR_UNFUSED
+#endif
+
+
+namespace detail {
+#if defined(VECTOR_DISPATCH_X86)
+    [[nodiscard]] inline isa detect_isa() noexcept {
+        __builtin_cpu_init();
+        isa level = isa::sse2;
+        if (__builtin_cpu_supports("avx2")) {
+            level = isa::avx2;
+        }
+        if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512vl") && __builtin_cpu_supports("avx512bw") && __builtin_cpu_supports("avx512dq")) {
+            level = isa::avx512;
+        }
+        // the override may only lower the level, a higher one would fault
+        if (const char* env = std::getenv("VECTOR_ISA")) {
+            const std::string_view name = env;
+            const isa wanted = name == "sse2" ? isa::sse2 : name == "avx2" ? isa::avx2 : name == "avx512" ? isa::avx512 : level;
+            level = std::min(level, wanted);
+        }
+        return level;
+    }
+
+    // callees are inlined so the whole loop is compiled for the level
+    [[gnu::flatten]] inline void run_sse2(const auto& f) {
+        f();
+    }
+
+    [[gnu::target("avx2,fma"), gnu::flatten]] inline void run_avx2(const auto& f) {
+        f();
+    }
+
+    [[gnu::target("avx512f,avx512vl,avx512bw,avx512dq,avx2,fma"), gnu::flatten]] inline void run_avx512(const auto& f) {
+        f();
+    }
+
+    [[gnu::target("avx2"), VECTOR_UNFUSED]] inline void run_avx2_unfused(const auto& f) {
+        f();
+    }
+
+    [[gnu::target("avx512f,avx512vl,avx512bw,avx512dq,avx2"), VECTOR_UNFUSED]] inline void run_avx512_unfused(const auto& f) {
+        f();
+    }
+#else
+    [[nodiscard]] inline isa detect_isa() noexcept {
+        return isa::sse2;
+    }
+#endif
+
+    // the baseline level of dispatch<false>, also where there is no dispatch
+    [[VECTOR_UNFUSED]] inline void run_unfused(const auto& f) {
+        f();
+    }
+}// namespace detail
+
+#undef VECTOR_UNFUSED
+
+
+// the level the batch kernels run at, detected once
+[[nodiscard]] inline isa active_isa() noexcept {
+    static const isa level = detail::detect_isa();
+    return level;
+}
+
+[[nodiscard]] constexpr std::string_view isa_name(isa level) noexcept {
+    switch (level) {
+        case isa::avx2:
+            return "avx2";
+        case isa::avx512:
+            return "avx512";
+        default:
+            return "sse2";
+    }
+}
+
+
+namespace detail {
+    // runs f compiled for active_isa(); unless fused, every operation of f is rounded as written on every level
+    template <bool fused = true>
+    void dispatch(const auto& f) {
+#if defined(VECTOR_DISPATCH_X86)
+        switch (active_isa()) {
+            case isa::avx512:
+                if constexpr (fused) {
+                    run_avx512(f);
+                } else {
+                    run_avx512_unfused(f);
+                }
+                break;
+            case isa::avx2:
+                if constexpr (fused) {
+                    run_avx2(f);
+                } else {
+                    run_avx2_unfused(f);
+                }
+                break;
+            default:
+                if constexpr (fused) {
+                    run_sse2(f);
+                } else {
+                    run_unfused(f);
+                }
+        }
+#else
+        if constexpr (fused) {
+            f();
+        } else {
+            run_unfused(f);
+        }
+#endif
+    }
+}// namespace detail
+
+
+// out[i] = f(in[i]), out must hold at least in.size() elements
+template <size_t N, detail::numeric T, typename Out, typename F>
+void batch_map(std::span<const Vector<N, T>> in, std::span<Out> out, const F& f) {
+    detail::dispatch([&] {
+        for (size_t i = 0; i < in.size(); i++) {
+            out[i] = f(in[i]);
+        }
+    });
+}
+
+// out[i] = f(a[i], b[i]), e.g. std::plus<>{} or a lambda over library operators
+template <size_t N, detail::numeric T, typename B, typename Out, typename F>
+void batch_map(std::span<const Vector<N, T>> a, std::span<const B> b, std::span<Out> out, const F& f) {
+    detail::dispatch([&] {
+        for (size_t i = 0; i < a.size(); i++) {
+            out[i] = f(a[i], b[i]);
+        }
+    });
+}
+
+// out[i] = in[i].cast<U>()
+template <size_t N, detail::numeric T, detail::numeric U>
+void batch_cast(std::span<const Vector<N, T>> in, std::span<Vector<N, U>> out) {
+    batch_map(in, out, [](const Vector<N, T>& v) { return v.template cast<U>(); });
+}
@@ -0,0 +1,369 @@
+#pragma once
+
+
+#include <cmath>
+
+#include <numbers>
+#include <ostream>
+#include <type_traits>
+
+#include "Vector.h"
+
+
+// forward-mode automatic differentiation: value plus the derivatives along K seed directions
+// the K tangents sit next to each other so every operation updates them in one contiguous, vectorizable loop
+// comparisons only look at the value, so branches in differentiated code follow the primal computation
+template <detail::floating T, size_t K = 1>
+    requires(K > 0)
+struct Dual {
+    using value_type = T;
+    static constexpr size_t directions = K;
+
+
+    T value;
+    T grad[K];// no initializers, Vector's unions need a trivial default constructor
+
+
+    constexpr Dual() noexcept = default;
+
+    // constants have no derivative
+    template <typename U>
+        requires(detail::integral<U> || detail::floating<U>)
+    constexpr Dual(U x) noexcept : value(static_cast<T>(x)), grad{} {}
+
+    // narrowing is explicit so mixed-precision operators only match the wider type's friends
+    template <detail::floating U>
+        requires(!std::is_same_v<U, T>)
+    constexpr explicit(sizeof(U) > sizeof(T)) Dual(const Dual<U, K>& d) noexcept : value(static_cast<T>(d.value)) {
+        for (size_t k = 0; k < K; k++) {
+            grad[k] = static_cast<T>(d.grad[k]);
+        }
+    }
+
+    // the independent variable along direction i
+    [[nodiscard]] static constexpr Dual variable(T x, size_t i = 0) noexcept {
+        Dual d = x;
+        d.grad[i] = 1;
+        return d;
+    }
+
+
+    [[nodiscard]] constexpr Dual operator+() const noexcept {
+        return *this;
+    }
+
+    [[nodiscard]] constexpr Dual operator-() const noexcept {
+        return map(-value, T{-1});
+    }
+
+    constexpr Dual& operator+=(const Dual& r) noexcept {
+        return *this = *this + r;
+    }
+
+    constexpr Dual& operator-=(const Dual& r) noexcept {
+        return *this = *this - r;
+    }
+
+    constexpr Dual& operator*=(const Dual& r) noexcept {
+        return *this = *this * r;
+    }
+
+    constexpr Dual& operator/=(const Dual& r) noexcept {
+        return *this = *this / r;
+    }
+
+
+    // value f and derivative df of a scalar function at value, chained into every direction
+    [[nodiscard]] constexpr Dual map(T f, T df) const noexcept {
+        Dual d;
+        d.value = f;
+        for (size_t k = 0; k < K; k++) {
+            d.grad[k] = df * grad[k];
+        }
+        return d;
+    }
+
+
+    // hidden friends, mixed with a scalar the scalar is a constant and its zero tangent is never touched
+    [[nodiscard]] friend constexpr Dual operator+(const Dual& l, const Dual& r) noexcept {
+        Dual d;
+        d.value = l.value + r.value;
+        for (size_t k = 0; k < K; k++) {
+            d.grad[k] = l.grad[k] + r.grad[k];
+        }
+        return d;
+    }
+
+    [[nodiscard]] friend constexpr Dual operator-(const Dual& l, const Dual& r) noexcept {
+        Dual d;
+        d.value = l.value - r.value;
+        for (size_t k = 0; k < K; k++) {
+            d.grad[k] = l.grad[k] - r.grad[k];
+        }
+        return d;
+    }
+
+    [[nodiscard]] friend constexpr Dual operator*(const Dual& l, const Dual& r) noexcept {
+        Dual d;
+        d.value = l.value * r.value;
+        for (size_t k = 0; k < K; k++) {
+            d.grad[k] = l.grad[k] * r.value + l.value * r.grad[k];
+        }
+        return d;
+    }
+
+    [[nodiscard]] friend constexpr Dual operator/(const Dual& l, const Dual& r) noexcept {
+        const T inv = 1 / r.value;
+        Dual d;
+        d.value = l.value * inv;
+        for (size_t k = 0; k < K; k++) {
+            d.grad[k] = (l.grad[k] - d.value * r.grad[k]) * inv;
+        }
+        return d;
+    }
+
+    [[nodiscard]] friend constexpr Dual operator+(const Dual& l, T r) noexcept {
+        Dual d = l;
+        d.value += r;
+        return d;
+    }
+
+    [[nodiscard]] friend constexpr Dual operator+(T l, const Dual& r) noexcept {
+        return r + l;
+    }
+
+    [[nodiscard]] friend constexpr Dual operator-(const Dual& l, T r) noexcept {
+        Dual d = l;
+        d.value -= r;
+        return d;
+    }
+
+    [[nodiscard]] friend constexpr Dual operator-(T l, const Dual& r) noexcept {
+        return r.map(l - r.value, T{-1});
+    }
+
+    [[nodiscard]] friend constexpr Dual operator*(const Dual& l, T r) noexcept {
+        return l.map(l.value * r, r);
+    }
+
+    [[nodiscard]] friend constexpr Dual operator*(T l, const Dual& r) noexcept {
+        return r.map(l * r.value, l);
+    }
+
+    [[nodiscard]] friend constexpr Dual operator/(const Dual& l, T r) noexcept {
+        return l.map(l.value / r, 1 / r);
+    }
+
+    [[nodiscard]] friend constexpr Dual operator/(T l, const Dual& r) noexcept {
+        const T q = l / r.value;
+        return r.map(q, -q / r.value);
+    }
+
+
+    friend constexpr bool operator==(const Dual& l, const Dual& r) noexcept {
+        return l.value == r.value;
+    }
+
+    friend constexpr auto operator<=>(const Dual& l, const Dual& r) noexcept {
+        return l.value <=> r.value;
+    }
+};
+
+
+namespace detail {
+    template <floating T, size_t K>
+    constexpr bool is_dual_v<Dual<T, K>> = true;
+}// namespace detail
+
+
+// math functions, found by Vector's members through ADL
+// abs goes by the sign bit like std::abs, so -0 and negative NaNs lose it too
+template <detail::floating T, size_t K>
+[[nodiscard]] constexpr Dual<T, K> abs(const Dual<T, K>& x) noexcept {
+    return std::signbit(x.value) ? -x : x;
+}
+
+template <detail::floating T, size_t K>
+[[nodiscard]] Dual<T, K> sqrt(const Dual<T, K>& x) noexcept {
+    const T s = std::sqrt(x.value);
+    return x.map(s, 1 / (2 * s));
+}
+
+template <detail::floating T, size_t K>
+[[nodiscard]] Dual<T, K> cbrt(const Dual<T, K>& x) noexcept {
+    const T c = std::cbrt(x.value);
+    return x.map(c, 1 / (3 * c * c));
+}
+
+template <detail::floating T, size_t K>
+[[nodiscard]] Dual<T, K> exp(const Dual<T, K>& x) noexcept {
+    const T e = std::exp(x.value);
+    return x.map(e, e);
+}
+
+template <detail::floating T, size_t K>
+[[nodiscard]] Dual<T, K> exp2(const Dual<T, K>& x) noexcept {
+    const T e = std::exp2(x.value);
+    return x.map(e, e * std::numbers::ln2_v<T>);
+}
+
+template <detail::floating T, size_t K>
+[[nodiscard]] Dual<T, K> expm1(const Dual<T, K>& x) noexcept {
+    return x.map(std::expm1(x.value), std::exp(x.value));
+}
+
+template <detail::floating T, size_t K>
+[[nodiscard]] Dual<T, K> log(const Dual<T, K>& x) noexcept {
+    return x.map(std::log(x.value), 1 / x.value);
+}
+
+template <detail::floating T, size_t K>
+[[nodiscard]] Dual<T, K> log2(const Dual<T, K>& x) noexcept {
+    return x.map(std::log2(x.value), 1 / (x.value * std::numbers::ln2_v<T>));
+}
+
+template <detail::floating T, size_t K>
+[[nodiscard]] Dual<T, K> log10(const Dual<T, K>& x) noexcept {
+    return x.map(std::log10(x.value), 1 / (x.value * std::numbers::ln10_v<T>));
+}
+
+template <detail::floating T, size_t K>
+[[nodiscard]] Dual<T, K> log1p(const Dual<T, K>& x) noexcept {
+    return x.map(std::log1p(x.value), 1 / (1 + x.value));
+}
+
+template <detail::floating T, size_t K>
+[[nodiscard]] Dual<T, K> sin(const Dual<T, K>& x) noexcept {
+    return x.map(std::sin(x.value), std::cos(x.value));
+}
+
+template <detail::floating T, size_t K>
+[[nodiscard]] Dual<T, K> cos(const Dual<T, K>& x) noexcept {
+    return x.map(std::cos(x.value), -std::sin(x.value));
+}
+
+template <detail::floating T, size_t K>
+[[nodiscard]] Dual<T, K> tan(const Dual<T, K>& x) noexcept {
+    const T t = std::tan(x.value);
+    return x.map(t, 1 + t * t);
+}
+
+template <detail::floating T, size_t K>
+[[nodiscard]] Dual<T, K> asin(const Dual<T, K>& x) noexcept {
+    return x.map(std::asin(x.value), 1 / std::sqrt(1 - x.value * x.value));
+}
+
+template <detail::floating T, size_t K>
+[[nodiscard]] Dual<T, K> acos(const Dual<T, K>& x) noexcept {
+    return x.map(std::acos(x.value), -1 / std::sqrt(1 - x.value * x.value));
+}
+
+template <detail::floating T, size_t K>
+[[nodiscard]] Dual<T, K> atan(const Dual<T, K>& x) noexcept {
+    return x.map(std::atan(x.value), 1 / (1 + x.value * x.value));
+}
+
+template <detail::floating T, size_t K>
+[[nodiscard]] Dual<T, K> sinh(const Dual<T, K>& x) noexcept {
+    return x.map(std::sinh(x.value), std::cosh(x.value));
+}
+
+template <detail::floating T, size_t K>
+[[nodiscard]] Dual<T, K> cosh(const Dual<T, K>& x) noexcept {
+    return x.map(std::cosh(x.value), std::sinh(x.value));
+}
+
+template <detail::floating T, size_t K>
+[[nodiscard]] Dual<T, K> tanh(const Dual<T, K>& x) noexcept {
+    const T t = std::tanh(x.value);
+    return x.map(t, 1 - t * t);
+}
+
+template <detail::floating T, size_t K>
+[[nodiscard]] Dual<T, K> asinh(const Dual<T, K>& x) noexcept {
+    return x.map(std::asinh(x.value), 1 / std::sqrt(x.value * x.value + 1));
+}
+
+template <detail::floating T, size_t K>
+[[nodiscard]] Dual<T, K> acosh(const Dual<T, K>& x) noexcept {
+    return x.map(std::acosh(x.value), 1 / std::sqrt(x.value * x.value - 1));
+}
+
+template <detail::floating T, size_t K>
+[[nodiscard]] Dual<T, K> atanh(const Dual<T, K>& x) noexcept {
+    return x.map(std::atanh(x.value), 1 / (1 - x.value * x.value));
+}
+
+template <detail::floating T, size_t K>
+[[nodiscard]] Dual<T, K> erf(const Dual<T, K>& x) noexcept {
+    return x.map(std::erf(x.value), 2 * std::numbers::inv_sqrtpi_v<T> * std::exp(-x.value * x.value));
+}
+
+template <detail::floating T, size_t K>
+[[nodiscard]] Dual<T, K> erfc(const Dual<T, K>& x) noexcept {
+    return x.map(std::erfc(x.value), -2 * std::numbers::inv_sqrtpi_v<T> * std::exp(-x.value * x.value));
+}
+
+// piecewise constant, zero derivative
+template <detail::floating T, size_t K>
+[[nodiscard]] Dual<T, K> floor(const Dual<T, K>& x) noexcept {
+    return x.map(std::floor(x.value), T{0});
+}
+
+template <detail::floating T, size_t K>
+[[nodiscard]] Dual<T, K> ceil(const Dual<T, K>& x) noexcept {
+    return x.map(std::ceil(x.value), T{0});
+}
+
+template <detail::floating T, size_t K>
+[[nodiscard]] Dual<T, K> trunc(const Dual<T, K>& x) noexcept {
+    return x.map(std::trunc(x.value), T{0});
+}
+
+template <detail::floating T, size_t K>
+[[nodiscard]] Dual<T, K> round(const Dual<T, K>& x) noexcept {
+    return x.map(std::round(x.value), T{0});
+}
+
+template <detail::floating T, size_t K>
+std::ostream& operator<<(std::ostream& os, const Dual<T, K>& d) {
+    os << d.value << " [" << d.grad[0];
+    for (size_t k = 1; k < K; k++) {
+        os << ", " << d.grad[k];
+    }
+    return os << "]";
+}
+
+
+// x with lane i as the independent variable along direction i, so one evaluation of f(seed(x)) carries the full gradient
+template <size_t N, detail::floating T>
+[[nodiscard]] constexpr Vector<N, Dual<T, N>> seed(const Vector<N, T>& x) noexcept {
+    return [&]<size_t... Is>(std::index_sequence<Is...>) {
+        return Vector<N, Dual<T, N>>{Dual<T, N>::variable(x[Is], Is)...};
+    }(std::make_index_sequence<N>{});
+}
+
+// gradient of a scalar result computed from seed(x)
+template <detail::floating T, size_t K>
+    requires(K >= 2 && K <= 4)
+[[nodiscard]] constexpr Vector<K, T> gradient(const Dual<T, K>& d) noexcept {
+    return Vector<K, T>(d.grad);
+}
+
+template <size_t N, detail::floating T, size_t K>
+[[nodiscard]] constexpr Vector<N, T> values(const Vector<N, Dual<T, K>>& v) noexcept {
+    return [&]<size_t... Is>(std::index_sequence<Is...>) {
+        return Vector<N, T>{v[Is].value...};
+    }(std::make_index_sequence<N>{});
+}
+
+// derivative of every lane along seed direction i, i.e. column i of the Jacobian
+template <size_t N, detail::floating T, size_t K>
+[[nodiscard]] constexpr Vector<N, T> derivatives(const Vector<N, Dual<T, K>>& v, size_t i) noexcept {
+    return [&]<size_t... Is>(std::index_sequence<Is...>) {
+        return Vector<N, T>{v[Is].grad[i]...};
+    }(std::make_index_sequence<N>{});
+}
+
+
+static_assert(detail::bitwise_copyable<Vector<3, Dual<double, 3>>>);
@@ -0,0 +1,246 @@
+#pragma once
+
+
+#include <cstdint>
+
+#include <compare>
+#include <ostream>
+#include <type_traits>
+
+#if defined(__SSE2__)
+    #include <immintrin.h>
+#endif
+
+#include "Vector.h"
+
+
+// two's complement fixed point with F fraction bits stored in Rep
+// products and quotients are computed at twice the width and rescaled with an arithmetic shift, i.e. rounded toward negative infinity
+// conversions to and from every other numeric type are implicit so Vector's element-wise operators and cast work unchanged
+template <detail::signed_integral Rep, size_t F>
+    requires(sizeof(Rep) <= 4 && F < sizeof(Rep) * 8)
+struct Fixed {
+    using rep = Rep;
+    static constexpr size_t fraction_bits = F;
+
+
+    Rep raw;// no initializer, Vector's unions need a trivial default constructor
+
+
+    constexpr Fixed() noexcept = default;
+
+    template <detail::integral I>
+    constexpr Fixed(I i) noexcept : raw(static_cast<Rep>(static_cast<int64_t>(i) << F)) {}
+
+    // rounds half away from zero
+    template <detail::floating U>
+    constexpr Fixed(U f) noexcept : raw(static_cast<Rep>(static_cast<int64_t>(f * static_cast<U>(int64_t{1} << F) + (f < 0 ? U(-0.5) : U(0.5))))) {}
+
+    template <detail::signed_integral R, size_t G>
+    constexpr Fixed(Fixed<R, G> f) noexcept {
+        if constexpr (G > F) {
+            raw = static_cast<Rep>(f.raw >> (G - F));
+        } else {
+            raw = static_cast<Rep>(static_cast<int64_t>(f.raw) << (F - G));
+        }
+    }
+
+    [[nodiscard]] static constexpr Fixed from_raw(Rep r) noexcept {
+        Fixed f;
+        f.raw = r;
+        return f;
+    }
+
+
+    template <detail::floating U>
+    constexpr operator U() const noexcept {
+        return static_cast<U>(raw) / static_cast<U>(int64_t{1} << F);
+    }
+
+    // rounds toward negative infinity
+    template <detail::integral I>
+    constexpr operator I() const noexcept {
+        if constexpr (std::is_same_v<I, bool>) {
+            return raw != 0;
+        } else {
+            return static_cast<I>(raw >> F);
+        }
+    }
+
+
+    [[nodiscard]] constexpr Fixed operator+() const noexcept {
+        return *this;
+    }
+
+    [[nodiscard]] constexpr Fixed operator-() const noexcept {
+        return from_raw(static_cast<Rep>(-static_cast<int64_t>(raw)));
+    }
+
+    constexpr Fixed& operator++() noexcept {
+        return *this = *this + 1;
+    }
+
+    constexpr Fixed& operator--() noexcept {
+        return *this = *this - 1;
+    }
+
+    constexpr Fixed operator++(int) noexcept {
+        const Fixed tmp = *this;
+        ++*this;
+        return tmp;
+    }
+
+    constexpr Fixed operator--(int) noexcept {
+        const Fixed tmp = *this;
+        --*this;
+        return tmp;
+    }
+
+    // the result goes through the common type and converts back, like the built-in compound assignments
+    constexpr Fixed& operator+=(detail::numeric auto r) noexcept {
+        return *this = *this + r;
+    }
+
+    constexpr Fixed& operator-=(detail::numeric auto r) noexcept {
+        return *this = *this - r;
+    }
+
+    constexpr Fixed& operator*=(detail::numeric auto r) noexcept {
+        return *this = *this * r;
+    }
+
+    constexpr Fixed& operator/=(detail::numeric auto r) noexcept {
+        return *this = *this / r;
+    }
+
+
+    friend constexpr bool operator==(Fixed, Fixed) noexcept = default;
+    friend constexpr auto operator<=>(Fixed, Fixed) noexcept = default;
+};
+
+
+using q8_8 = Fixed<int16_t, 8>;
+using q16_16 = Fixed<int32_t, 16>;
+
+
+namespace detail {
+    template <signed_integral Rep, size_t F>
+    constexpr bool is_fixed_point_v<Fixed<Rep, F>> = true;
+
+    template <typename L, typename R>
+    concept fixed_operands = numeric<L> && numeric<R> && (fixed_point<L> || fixed_point<R>);
+
+    // room for a full product of two reps
+    template <fixed_point T>
+    using fixed_wide_t = std::conditional_t<(sizeof(typename T::rep) < 4), int32_t, int64_t>;
+}// namespace detail
+
+
+// mixed operands are converted to their common type first, fixed results are computed on widened reps
+template <typename L, typename R>
+    requires detail::fixed_operands<L, R>
+[[nodiscard]] constexpr auto operator+(L l, R r) noexcept {
+    using C = detail::common_type_t<L, R>;
+    if constexpr (detail::fixed_point<C>) {
+        using W = detail::fixed_wide_t<C>;
+        return C::from_raw(static_cast<typename C::rep>(static_cast<W>(C(l).raw) + C(r).raw));
+    } else {
+        return C(l) + C(r);
+    }
+}
+
+template <typename L, typename R>
+    requires detail::fixed_operands<L, R>
+[[nodiscard]] constexpr auto operator-(L l, R r) noexcept {
+    using C = detail::common_type_t<L, R>;
+    if constexpr (detail::fixed_point<C>) {
+        using W = detail::fixed_wide_t<C>;
+        return C::from_raw(static_cast<typename C::rep>(static_cast<W>(C(l).raw) - C(r).raw));
+    } else {
+        return C(l) - C(r);
+    }
+}
+
+template <typename L, typename R>
+    requires detail::fixed_operands<L, R>
+[[nodiscard]] constexpr auto operator*(L l, R r) noexcept {
+    using C = detail::common_type_t<L, R>;
+    if constexpr (detail::fixed_point<C>) {
+        using W = detail::fixed_wide_t<C>;
+        return C::from_raw(static_cast<typename C::rep>(static_cast<W>(C(l).raw) * C(r).raw >> C::fraction_bits));
+    } else {
+        return C(l) * C(r);
+    }
+}
+
+template <typename L, typename R>
+    requires detail::fixed_operands<L, R>
+[[nodiscard]] constexpr auto operator/(L l, R r) noexcept {
+    using C = detail::common_type_t<L, R>;
+    if constexpr (detail::fixed_point<C>) {
+        using W = detail::fixed_wide_t<C>;
+        return C::from_raw(static_cast<typename C::rep>((static_cast<W>(C(l).raw) << C::fraction_bits) / C(r).raw));
+    } else {
+        return C(l) / C(r);
+    }
+}
+
+template <typename L, typename R>
+    requires detail::fixed_operands<L, R> && (!std::is_same_v<L, R>)
+[[nodiscard]] constexpr bool operator==(L l, R r) noexcept {
+    using C = detail::common_type_t<L, R>;
+    return C(l) == C(r);
+}
+
+template <typename L, typename R>
+    requires detail::fixed_operands<L, R> && (!std::is_same_v<L, R>)
+[[nodiscard]] constexpr auto operator<=>(L l, R r) noexcept {
+    using C = detail::common_type_t<L, R>;
+    return C(l) <=> C(r);
+}
+
+
+template <detail::signed_integral Rep, size_t F>
+std::ostream& operator<<(std::ostream& os, Fixed<Rep, F> f) {
+    return os << static_cast<double>(f);
+}
+
+
+// packed products for full vectors: pmuldq on the even and odd lane pairs for Q*.* in 32 bits,
+// pmullw/pmulhw halves recombined for Q*.* in 16 bits
+#if defined(__SSE4_1__)
+template <size_t F>
+[[nodiscard]] constexpr Vector<4, Fixed<int32_t, F>> operator*(const Vector<4, Fixed<int32_t, F>>& lhs, const Vector<4, Fixed<int32_t, F>>& rhs) noexcept {
+    if !consteval {
+        const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&lhs[0]));
+        const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&rhs[0]));
+        // bits F .. F + 31 of each 64-bit product, moved to the low half for even lanes and the high half for odd lanes
+        const __m128i even = _mm_srli_epi64(_mm_mul_epi32(a, b), F);
+        const __m128i odd = _mm_slli_epi64(_mm_mul_epi32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32)), 32 - F);
+        Vector<4, Fixed<int32_t, F>> out;
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(&out[0]), _mm_blend_epi16(even, odd, 0xcc));
+        return out;
+    }
+    return detail::binary_func(lhs, rhs, [](auto l, auto r) { return l * r; });
+}
+#endif
+
+#if defined(__SSE2__)
+template <size_t F>
+[[nodiscard]] constexpr Vector<4, Fixed<int16_t, F>> operator*(const Vector<4, Fixed<int16_t, F>>& lhs, const Vector<4, Fixed<int16_t, F>>& rhs) noexcept {
+    if !consteval {
+        const __m128i a = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(&lhs[0]));
+        const __m128i b = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(&rhs[0]));
+        const __m128i hi = _mm_slli_epi16(_mm_mulhi_epi16(a, b), 16 - F);
+        const __m128i lo = _mm_srli_epi16(_mm_mullo_epi16(a, b), F);
+        Vector<4, Fixed<int16_t, F>> out;
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(&out[0]), _mm_or_si128(hi, lo));
+        return out;
+    }
+    return detail::binary_func(lhs, rhs, [](auto l, auto r) { return l * r; });
+}
+#endif
+
+
+static_assert(detail::bitwise_copyable<Vector<4, q16_16>>);
+static_assert(detail::bitwise_copyable<Vector<4, q8_8>>);
@@ -0,0 +1,162 @@
+#pragma once
+
+
+#include <cstring>
+
+#include <span>
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+#include "Vector.h"
+
+
+namespace detail {
+    template <typename T>
+    concept lane32 = is_any_of_v<std::remove_cv_t<T>, float, int32_t, uint32_t>;
+
+    template <typename T>
+    concept lane64 = is_any_of_v<std::remove_cv_t<T>, double, int64_t, uint64_t>;
+
+
+    // pshufb control for a runtime permutation of a Vector whose bytes fit into the low half of an xmm register
+    template <size_t N, numeric T>
+    struct byte_shuffle {
+        uint8_t ctrl[16];
+
+        constexpr explicit byte_shuffle(const Vector<N, uint8_t>& pattern) noexcept : ctrl{} {
+            std::fill_n(ctrl, 16, uint8_t{0x80});
+            for (size_t i = 0; i < N; i++) {
+                for (size_t k = 0; k < sizeof(T); k++) {
+                    ctrl[i * sizeof(T) + k] = static_cast<uint8_t>(pattern[i] * sizeof(T) + k);
+                }
+            }
+        }
+
+        [[nodiscard]] Vector<N, T> apply(const Vector<N, T>& v) const noexcept {
+#if defined(__SSSE3__)
+            uint64_t bits = 0;
+            std::memcpy(&bits, v.data, N * sizeof(T));
+            const __m128i r = _mm_shuffle_epi8(_mm_cvtsi64_si128(static_cast<long long>(bits)), _mm_loadu_si128(reinterpret_cast<const __m128i*>(ctrl)));
+            bits = static_cast<uint64_t>(_mm_cvtsi128_si64(r));
+            T out[N];
+            std::memcpy(out, &bits, N * sizeof(T));
+            return Vector<N, T>(out);
+#else
+            uint8_t in[N * sizeof(T)], out[N * sizeof(T)];
+            std::memcpy(in, v.data, sizeof(in));
+            for (size_t i = 0; i < sizeof(out); i++) {
+                out[i] = in[ctrl[i]];
+            }
+            T es[N];
+            std::memcpy(es, out, sizeof(out));
+            return Vector<N, T>(es);
+#endif
+        }
+    };
+}// namespace detail
+
+
+// r[i] = base[idx[i]]
+template <size_t N, detail::numeric T, detail::integral I>
+[[nodiscard]] constexpr Vector<N, T> gather(const T* base, const Vector<N, I>& idx) noexcept {
+#if defined(__AVX2__)
+    if !consteval {
+        if constexpr (N == 4 && std::is_same_v<I, int32_t> && (detail::lane32<T> || detail::lane64<T>)) {
+            const __m128i vi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(idx.data));
+            T out[4];
+            if constexpr (std::is_same_v<T, float>) {
+                _mm_storeu_ps(out, _mm_i32gather_ps(base, vi, 4));
+            } else if constexpr (detail::lane32<T>) {
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm_i32gather_epi32(reinterpret_cast<const int*>(base), vi, 4));
+            } else if constexpr (std::is_same_v<T, double>) {
+                _mm256_storeu_pd(out, _mm256_i32gather_pd(base, vi, 8));
+            } else {
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), _mm256_i32gather_epi64(reinterpret_cast<const long long*>(base), vi, 8));
+            }
+            return Vector<4, T>(out);
+        }
+    }
+#endif
+    return [&]<size_t... Is>(std::index_sequence<Is...>) {
+        return Vector<N, T>{base[idx[Is]]...};
+    }(std::make_index_sequence<N>{});
+}
+
+// base[idx[i]] = v[i], later lanes win on duplicate indices
+template <size_t N, detail::numeric T, detail::integral I>
+constexpr void scatter(T* base, const Vector<N, I>& idx, const Vector<N, T>& v) noexcept {
+#if defined(__AVX512F__) && defined(__AVX512VL__)
+    if !consteval {
+        if constexpr (N == 4 && std::is_same_v<I, int32_t> && (detail::lane32<T> || detail::lane64<T>)) {
+            const __m128i vi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(idx.data));
+            if constexpr (std::is_same_v<T, float>) {
+                _mm_i32scatter_ps(base, vi, _mm_loadu_ps(v.data), 4);
+            } else if constexpr (detail::lane32<T>) {
+                _mm_i32scatter_epi32(base, vi, _mm_loadu_si128(reinterpret_cast<const __m128i*>(v.data)), 4);
+            } else if constexpr (std::is_same_v<T, double>) {
+                _mm256_i32scatter_pd(base, vi, _mm256_loadu_pd(v.data), 8);
+            } else {
+                _mm256_i32scatter_epi64(base, vi, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(v.data)), 8);
+            }
+            return;
+        }
+    }
+#endif
+    [&]<size_t... Is>(std::index_sequence<Is...>) {
+        (..., (base[idx[Is]] = v[Is]));
+    }(std::make_index_sequence<N>{});
+}
+
+// r[i] = v[pattern[i]], every pattern[i] must be less than N
+template <size_t N, detail::numeric T>
+[[nodiscard]] constexpr Vector<N, T> permute(const Vector<N, T>& v, const Vector<N, uint8_t>& pattern) noexcept {
+#if defined(__AVX__)
+    if !consteval {
+        if constexpr (N == 4 && detail::lane32<T>) {
+            int32_t packed;
+            std::memcpy(&packed, pattern.data, 4);
+            const __m128i ctrl = _mm_cvtepu8_epi32(_mm_cvtsi32_si128(packed));
+            T out[4];
+            _mm_storeu_ps(reinterpret_cast<float*>(out), _mm_permutevar_ps(_mm_loadu_ps(reinterpret_cast<const float*>(v.data)), ctrl));
+            return Vector<4, T>(out);
+        }
+    }
+#endif
+    return [&]<size_t... Is>(std::index_sequence<Is...>) {
+        return Vector<N, T>{v[pattern[Is]]...};
+    }(std::make_index_sequence<N>{});
+}
+
+
+// batched versions, out must hold at least idx.size() / v.size() elements
+template <size_t N, detail::numeric T, detail::integral I>
+constexpr void gather(std::span<Vector<N, T>> out, const T* base, std::span<const Vector<N, I>> idx) noexcept {
+    for (size_t i = 0; i < idx.size(); i++) {
+        out[i] = gather(base, idx[i]);
+    }
+}
+
+template <size_t N, detail::numeric T, detail::integral I>
+constexpr void scatter(T* base, std::span<const Vector<N, I>> idx, std::span<const Vector<N, T>> v) noexcept {
+    for (size_t i = 0; i < idx.size(); i++) {
+        scatter(base, idx[i], v[i]);
+    }
+}
+
+template <size_t N, detail::numeric T>
+constexpr void permute(std::span<Vector<N, T>> out, std::span<const Vector<N, T>> v, const Vector<N, uint8_t>& pattern) noexcept {
+    if !consteval {
+        if constexpr (sizeof(T) * N <= 8 && sizeof(T) <= 2) {
+            const detail::byte_shuffle<N, T> shuffle(pattern);
+            for (size_t i = 0; i < v.size(); i++) {
+                out[i] = shuffle.apply(v[i]);
+            }
+            return;
+        }
+    }
+    for (size_t i = 0; i < v.size(); i++) {
+        out[i] = permute(v[i], pattern);
+    }
+}
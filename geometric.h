@@ -0,0 +1,42 @@
+#pragma once
+
+
+#include <cmath>
+
+#include "Vector.h"
+
+
+// GLSL geometric functions, operands may be Vectors or Swizzles
+
+template <std::derived_from<detail::Base> L, std::derived_from<detail::Base> R>
+    requires(L::dim == R::dim)
+[[nodiscard]] constexpr auto dot(const L& lhs, const R& rhs) noexcept {
+    using C = detail::common_type_t<typename L::element_type, typename R::element_type>;
+    return [&]<size_t... Is>(std::index_sequence<Is...>) -> C {
+        return (... + (static_cast<C>(lhs[Is]) * static_cast<C>(rhs[Is])));
+    }(std::make_index_sequence<L::dim>{});
+}
+
+template <std::derived_from<detail::Base> L, std::derived_from<detail::Base> R>
+    requires(L::dim == 3 && R::dim == 3)
+[[nodiscard]] constexpr auto cross(const L& lhs, const R& rhs) noexcept {
+    using C = detail::common_type_t<typename L::element_type, typename R::element_type>;
+    return Vector<3, C>(static_cast<C>(lhs[1] * rhs[2] - lhs[2] * rhs[1]),
+                        static_cast<C>(lhs[2] * rhs[0] - lhs[0] * rhs[2]),
+                        static_cast<C>(lhs[0] * rhs[1] - lhs[1] * rhs[0]));
+}
+
+[[nodiscard]] constexpr auto length(const std::derived_from<detail::Base> auto& v) noexcept {
+    using std::sqrt;
+    return sqrt(dot(v, v));
+}
+
+template <std::derived_from<detail::Base> L, std::derived_from<detail::Base> R>
+    requires(L::dim == R::dim)
+[[nodiscard]] constexpr auto distance(const L& lhs, const R& rhs) noexcept {
+    return length(lhs - rhs);
+}
+
+[[nodiscard]] constexpr auto normalize(const std::derived_from<detail::Base> auto& v) noexcept {
+    return v / length(v);
+}
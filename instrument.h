@@ -0,0 +1,172 @@
+#pragma once
+
+
+#include <cstdint>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+#include "type_helper.h"
+
+
+// per-operation counters for Vector.h, only hooked in when VECTOR_INSTRUMENT is defined
+// every thread bumps its own counters, snapshot() merges them with those of exited threads
+namespace instrument {
+    enum class op : uint8_t {
+        unary,            // Base::unary_func, including cast
+        binary,           // binary_func with Vector/Swizzle operands on both sides
+        binary_scalar,    // binary_func with a scalar operand
+        inplace,          // MutableBase::inplace_func with a Vector/Swizzle operand
+        inplace_alias,    // the subset of inplace whose operand aliases the target and is copied first
+        inplace_scalar,   // MutableBase::inplace_func with a scalar operand
+        inplace_unary,    // increment and decrement
+        swizzle_to_vector,// VectorBase(const Swizzle&)
+        count
+    };
+
+    constexpr const char* op_names[]{"unary", "binary", "binary_scalar", "inplace", "inplace_alias", "inplace_scalar", "inplace_unary", "swizzle_to_vector"};
+
+
+    namespace detail {
+        using ::detail::numeric;
+
+        template <typename T, typename... Ts>
+        constexpr size_t index_of() noexcept {
+            constexpr bool matches[]{std::is_same_v<T, Ts>...};
+            return std::find(std::begin(matches), std::end(matches), true) - std::begin(matches);
+        }
+
+        // element types outside the list, e.g. fixed point, share the trailing "other" slot
+        template <typename T>
+        constexpr size_t type_id = index_of<std::remove_cv_t<T>, bool, int8_t, int16_t, int32_t, int64_t, uint8_t, uint16_t, uint32_t, uint64_t, float, double>();
+
+        constexpr const char* type_names[]{"bool", "int8_t", "int16_t", "int32_t", "int64_t", "uint8_t", "uint16_t", "uint32_t", "uint64_t", "float", "double", "other"};
+
+        constexpr size_t type_count = std::size(type_names);
+        constexpr size_t dim_count = 5;// dims 0..4, Vector only uses 2..4
+        constexpr size_t slot_count = static_cast<size_t>(op::count) * dim_count * type_count;
+
+        constexpr size_t slot(op kind, size_t dim, size_t type) noexcept {
+            return (static_cast<size_t>(kind) * dim_count + dim) * type_count + type;
+        }
+
+
+        struct ThreadCounters;
+
+        struct Registry {
+            std::mutex mutex;
+            std::vector<ThreadCounters*> live;
+            std::array<uint64_t, slot_count> retired{};
+        };
+
+        inline Registry& registry() {
+            static Registry r;
+            return r;
+        }
+
+        struct ThreadCounters {
+            std::array<std::atomic<uint64_t>, slot_count> counts{};
+
+            ThreadCounters() {
+                Registry& r = registry();
+                std::lock_guard lock(r.mutex);
+                r.live.push_back(this);
+            }
+
+            ~ThreadCounters() {
+                Registry& r = registry();
+                std::lock_guard lock(r.mutex);
+                for (size_t i = 0; i < slot_count; i++) {
+                    r.retired[i] += counts[i].load(std::memory_order_relaxed);
+                }
+                std::erase(r.live, this);
+            }
+        };
+
+        inline thread_local ThreadCounters thread_counters;
+
+
+        // only the owning thread writes, so a relaxed load and store is enough and avoids a locked add
+        template <numeric T>
+        inline void count(op kind, size_t dim) noexcept {
+            auto& c = thread_counters.counts[slot(kind, dim, type_id<T>)];
+            c.store(c.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        }
+    }// namespace detail
+
+
+    class Snapshot {
+    public:
+        template <::detail::numeric T>
+        [[nodiscard]] uint64_t get(op kind, size_t dim) const noexcept {
+            return counts[detail::slot(kind, dim, detail::type_id<T>)];
+        }
+
+        [[nodiscard]] uint64_t total(op kind) const noexcept {
+            uint64_t sum = 0;
+            for (size_t i = detail::slot(kind, 0, 0); i < detail::slot(kind, detail::dim_count, 0); i++) {
+                sum += counts[i];
+            }
+            return sum;
+        }
+
+        // one line per non-zero counter: kind, dim, element type and count
+        friend std::ostream& operator<<(std::ostream& os, const Snapshot& s) {
+            for (size_t k = 0; k < static_cast<size_t>(op::count); k++) {
+                for (size_t d = 0; d < detail::dim_count; d++) {
+                    for (size_t t = 0; t < detail::type_count; t++) {
+                        if (const uint64_t n = s.counts[detail::slot(static_cast<op>(k), d, t)]) {
+                            os << op_names[k] << " Vector<" << d << ", " << detail::type_names[t] << ">: " << n << "\n";
+                        }
+                    }
+                }
+            }
+            return os;
+        }
+
+    private:
+        friend Snapshot snapshot();
+
+        std::array<uint64_t, detail::slot_count> counts{};
+    };
+
+
+    inline Snapshot snapshot() {
+        detail::Registry& r = detail::registry();
+        std::lock_guard lock(r.mutex);
+        Snapshot s;
+        s.counts = r.retired;
+        for (const detail::ThreadCounters* t : r.live) {
+            for (size_t i = 0; i < detail::slot_count; i++) {
+                s.counts[i] += t->counts[i].load(std::memory_order_relaxed);
+            }
+        }
+        return s;
+    }
+
+    // counts bumped concurrently by other threads may survive the reset
+    inline void reset() {
+        detail::Registry& r = detail::registry();
+        std::lock_guard lock(r.mutex);
+        r.retired.fill(0);
+        for (detail::ThreadCounters* t : r.live) {
+            for (auto& c : t->counts) {
+                c.store(0, std::memory_order_relaxed);
+            }
+        }
+    }
+
+    inline void report(std::ostream& os) {
+        os << snapshot();
+    }
+}// namespace instrument
+
+
+#define VECTOR_INSTRUMENT_COUNT(kind, dim, ...)                             \
+    if !consteval {                                                         \
+        ::instrument::detail::count<__VA_ARGS__>(::instrument::op::kind, dim); \
+    }
@@ -0,0 +1,320 @@
+#pragma once
+
+
+#include <cmath>
+
+#include <algorithm>
+#include <limits>
+#include <ostream>
+#include <type_traits>
+
+#if defined(__SSE2__)
+    #include <immintrin.h>
+#endif
+
+#include "Vector.h"
+
+
+namespace detail {
+    // Rump, Zimmermann, Boldo, Melquiond: if c is the round-to-nearest result of +, -, *, / or sqrt then
+    // c - (|c| * phi + eta) <= pred(c) and c + (|c| * phi + eta) >= succ(c), so the exact result lies in between
+    // this needs no rounding mode switch and vectorizes; eta is the smallest normal so flush-to-zero stays safe
+    template <floating T>
+    constexpr T round_phi = std::numeric_limits<T>::epsilon() / 2 * (1 + std::numeric_limits<T>::epsilon());
+
+    template <floating T>
+    [[nodiscard]] constexpr T widening(T c) noexcept {
+        // capped so infinite bounds stay infinite instead of becoming NaN
+        return std::min(std::abs(c) * round_phi<T> + std::numeric_limits<T>::min(), std::numeric_limits<T>::max());
+    }
+
+    template <floating T>
+    [[nodiscard]] constexpr T round_down(T c) noexcept {
+        return c - widening(c);
+    }
+
+    template <floating T>
+    [[nodiscard]] constexpr T round_up(T c) noexcept {
+        return c + widening(c);
+    }
+
+    // a corner product bounding x * y, 0 * inf is the limit 0 instead of a NaN that min/max would drop
+    template <floating T>
+    [[nodiscard]] constexpr T bound_product(T a, T b) noexcept {
+        constexpr T inf = std::numeric_limits<T>::infinity();
+        return (a == 0 && (b == inf || b == -inf)) || (b == 0 && (a == inf || a == -inf)) ? T{0} : a * b;
+    }
+
+    // a corner quotient bounding x / y on the side upper selects; inf / inf is any value of its sign,
+    // from 0 up to the infinity, so it contributes the infinity to its outer bound and 0 to the inner one
+    template <bool upper, floating T>
+    [[nodiscard]] constexpr T bound_quotient(T a, T b) noexcept {
+        constexpr T inf = std::numeric_limits<T>::infinity();
+        if ((a == inf || a == -inf) && (b == inf || b == -inf)) {
+            const bool negative = (a < 0) != (b < 0);
+            return upper ? (negative ? T{0} : inf) : (negative ? -inf : T{0});
+        }
+        return a / b;
+    }
+
+#if defined(__SSE2__)
+    // both bounds of an Interval<double> at once, lo in the low lane
+    [[nodiscard]] inline __m128d round_outward(__m128d c) noexcept {
+        const __m128d sign = _mm_set1_pd(-0.0);
+        const __m128d e = _mm_min_pd(_mm_add_pd(_mm_mul_pd(_mm_andnot_pd(sign, c), _mm_set1_pd(round_phi<double>)), _mm_set1_pd(std::numeric_limits<double>::min())),
+                                     _mm_set1_pd(std::numeric_limits<double>::max()));
+        return _mm_add_pd(c, _mm_xor_pd(e, _mm_move_sd(_mm_setzero_pd(), sign)));
+    }
+
+    [[nodiscard]] inline __m128d bound_product(__m128d a, __m128d b) noexcept {
+        const __m128d p = _mm_mul_pd(a, b);
+        return _mm_andnot_pd(_mm_and_pd(_mm_cmpunord_pd(p, p), _mm_and_pd(_mm_cmpord_pd(a, a), _mm_cmpord_pd(b, b))), p);
+    }
+#endif
+}// namespace detail
+
+
+// closed interval [lo, hi] that always contains the exact result of the operations applied to it
+// every bound is computed in round-to-nearest and widened afterwards, so the interval grows by about one ulp per operation
+// comparisons hold when they hold for every pair of points, i.e. !(a < b) does not imply a >= b
+template <detail::floating T>
+struct Interval {
+    using value_type = T;
+
+
+    T lo, hi;// no initializers, Vector's unions need a trivial default constructor
+
+
+    constexpr Interval() noexcept = default;
+
+    constexpr Interval(T x) noexcept : lo(x), hi(x) {}
+
+    constexpr Interval(T lo, T hi) noexcept : lo(lo), hi(hi) {}
+
+    // values T cannot hold exactly get the two neighbours around them
+    template <detail::numeric U>
+        requires(!std::is_same_v<U, T> && (detail::integral<U> || detail::floating<U>))
+    constexpr Interval(U x) noexcept : lo(static_cast<T>(x)), hi(lo) {
+        if constexpr (detail::floating<U>) {
+            lo = lo <= x ? lo : detail::round_down(lo);
+            hi = hi >= x ? hi : detail::round_up(hi);
+        } else if constexpr (std::numeric_limits<U>::digits > std::numeric_limits<T>::digits) {
+            lo = detail::round_down(lo);
+            hi = detail::round_up(hi);
+        }
+    }
+
+    // narrowing is explicit so mixed-precision operators only match the wider type's friends
+    template <detail::floating U>
+        requires(!std::is_same_v<U, T>)
+    constexpr explicit(sizeof(U) > sizeof(T)) Interval(Interval<U> i) noexcept : lo(Interval(i.lo).lo), hi(Interval(i.hi).hi) {}
+
+
+    [[nodiscard]] constexpr T mid() const noexcept {
+        return lo / 2 + hi / 2;
+    }
+
+    // rounded up
+    [[nodiscard]] constexpr T width() const noexcept {
+        return detail::round_up(hi - lo);
+    }
+
+    [[nodiscard]] constexpr bool contains(T x) const noexcept {
+        return lo <= x && x <= hi;
+    }
+
+
+    [[nodiscard]] constexpr Interval operator+() const noexcept {
+        return *this;
+    }
+
+    [[nodiscard]] constexpr Interval operator-() const noexcept {
+        return {-hi, -lo};
+    }
+
+    constexpr Interval& operator+=(Interval r) noexcept {
+        return *this = *this + r;
+    }
+
+    constexpr Interval& operator-=(Interval r) noexcept {
+        return *this = *this - r;
+    }
+
+    constexpr Interval& operator*=(Interval r) noexcept {
+        return *this = *this * r;
+    }
+
+    constexpr Interval& operator/=(Interval r) noexcept {
+        return *this = *this / r;
+    }
+
+
+    // hidden friends so scalar operands convert, with outward rounding where needed
+    [[nodiscard]] friend constexpr Interval operator+(Interval l, Interval r) noexcept {
+#if defined(__SSE2__)
+        if constexpr (std::is_same_v<T, double>) {
+            if !consteval {
+                return store(detail::round_outward(_mm_add_pd(load(l), load(r))));
+            }
+        }
+#endif
+        return {detail::round_down(l.lo + r.lo), detail::round_up(l.hi + r.hi)};
+    }
+
+    [[nodiscard]] friend constexpr Interval operator-(Interval l, Interval r) noexcept {
+#if defined(__SSE2__)
+        if constexpr (std::is_same_v<T, double>) {
+            if !consteval {
+                const __m128d b = load(r);
+                return store(detail::round_outward(_mm_sub_pd(load(l), _mm_shuffle_pd(b, b, 1))));
+            }
+        }
+#endif
+        return {detail::round_down(l.lo - r.hi), detail::round_up(l.hi - r.lo)};
+    }
+
+    // the extremes are among the four corner products, picked with min/max instead of the nine sign cases;
+    // a zero bound times an infinite one contributes 0, e.g. [1, inf] * [0, 1] = [0, inf]
+    [[nodiscard]] friend constexpr Interval operator*(Interval l, Interval r) noexcept {
+#if defined(__SSE2__)
+        if constexpr (std::is_same_v<T, double>) {
+            if !consteval {
+                const __m128d b = load(r);
+                const __m128d p = detail::bound_product(_mm_set1_pd(l.lo), b);
+                const __m128d q = detail::bound_product(_mm_set1_pd(l.hi), b);
+                const __m128d lo = _mm_min_pd(p, q), hi = _mm_max_pd(p, q);
+                const __m128d even = _mm_unpacklo_pd(lo, hi), odd = _mm_unpackhi_pd(lo, hi);
+                return store(detail::round_outward(_mm_move_sd(_mm_max_pd(even, odd), _mm_min_pd(even, odd))));
+            }
+        }
+#endif
+        const T p0 = detail::bound_product(l.lo, r.lo), p1 = detail::bound_product(l.lo, r.hi);
+        const T p2 = detail::bound_product(l.hi, r.lo), p3 = detail::bound_product(l.hi, r.hi);
+        return {detail::round_down(std::min(std::min(p0, p1), std::min(p2, p3))), detail::round_up(std::max(std::max(p0, p1), std::max(p2, p3)))};
+    }
+
+    // a divisor containing zero gives the whole line; infinite corners go to their limits, e.g. [-inf, 5] / [-inf, -1] = [-5, inf]
+    [[nodiscard]] friend constexpr Interval operator/(Interval l, Interval r) noexcept {
+        if (r.lo <= 0 && r.hi >= 0) {
+            return {-std::numeric_limits<T>::infinity(), std::numeric_limits<T>::infinity()};
+        }
+        using detail::bound_quotient;
+        const T lo = std::min(std::min(bound_quotient<false>(l.lo, r.lo), bound_quotient<false>(l.lo, r.hi)), std::min(bound_quotient<false>(l.hi, r.lo), bound_quotient<false>(l.hi, r.hi)));
+        const T hi = std::max(std::max(bound_quotient<true>(l.lo, r.lo), bound_quotient<true>(l.lo, r.hi)), std::max(bound_quotient<true>(l.hi, r.lo), bound_quotient<true>(l.hi, r.hi)));
+        return {detail::round_down(lo), detail::round_up(hi)};
+    }
+
+
+    // same bounds
+    friend constexpr bool operator==(Interval, Interval) noexcept = default;
+
+    friend constexpr bool operator<(Interval l, Interval r) noexcept {
+        return l.hi < r.lo;
+    }
+
+    friend constexpr bool operator<=(Interval l, Interval r) noexcept {
+        return l.hi <= r.lo;
+    }
+
+    friend constexpr bool operator>(Interval l, Interval r) noexcept {
+        return l.lo > r.hi;
+    }
+
+    friend constexpr bool operator>=(Interval l, Interval r) noexcept {
+        return l.lo >= r.hi;
+    }
+
+private:
+#if defined(__SSE2__)
+    static __m128d load(Interval i) noexcept {
+        return _mm_loadu_pd(&i.lo);
+    }
+
+    static Interval store(__m128d v) noexcept {
+        Interval i;
+        _mm_storeu_pd(&i.lo, v);
+        return i;
+    }
+#endif
+};
+
+
+template <size_t N, detail::floating T>
+using IntervalVector = Vector<N, Interval<T>>;
+
+
+namespace detail {
+    template <floating T>
+    constexpr bool is_interval_v<Interval<T>> = true;
+}// namespace detail
+
+
+// math functions, found by Vector's members through ADL
+// sqrt is correctly rounded by IEEE 754, exp and log come from libm and are widened twice to cover its last-place error
+template <detail::floating T>
+[[nodiscard]] constexpr Interval<T> abs(Interval<T> i) noexcept {
+    return {std::max(std::max(i.lo, -i.hi), T{0}), std::max(-i.lo, i.hi)};
+}
+
+template <detail::floating T>
+[[nodiscard]] Interval<T> sqrt(Interval<T> i) noexcept {
+    return {std::max(detail::round_down(std::sqrt(std::max(i.lo, T{0}))), T{0}), detail::round_up(std::sqrt(i.hi))};
+}
+
+template <detail::floating T>
+[[nodiscard]] Interval<T> exp(Interval<T> i) noexcept {
+    return {std::max(detail::round_down(detail::round_down(std::exp(i.lo))), T{0}), detail::round_up(detail::round_up(std::exp(i.hi)))};
+}
+
+template <detail::floating T>
+[[nodiscard]] Interval<T> log(Interval<T> i) noexcept {
+    return {detail::round_down(detail::round_down(std::log(i.lo))), detail::round_up(detail::round_up(std::log(i.hi)))};
+}
+
+template <detail::floating T>
+[[nodiscard]] constexpr Interval<T> floor(Interval<T> i) noexcept {
+    return {std::floor(i.lo), std::floor(i.hi)};
+}
+
+template <detail::floating T>
+[[nodiscard]] constexpr Interval<T> ceil(Interval<T> i) noexcept {
+    return {std::ceil(i.lo), std::ceil(i.hi)};
+}
+
+
+// -1 or 1 when every point has that sign, 0 when the interval touches zero and a predicate has to fall back to exact arithmetic
+template <detail::floating T>
+[[nodiscard]] constexpr int certain_sign(Interval<T> i) noexcept {
+    return (i.lo > 0) - (i.hi < 0);
+}
+
+template <detail::floating T>
+std::ostream& operator<<(std::ostream& os, Interval<T> i) {
+    return os << "[" << i.lo << ", " << i.hi << "]";
+}
+
+
+// lo / hi pairs such as AABB corners to intervals and back
+template <size_t N, detail::floating T>
+[[nodiscard]] constexpr IntervalVector<N, T> make_interval(const Vector<N, T>& lo, const Vector<N, T>& hi) noexcept {
+    return [&]<size_t... Is>(std::index_sequence<Is...>) {
+        return IntervalVector<N, T>{Interval<T>{lo[Is], hi[Is]}...};
+    }(std::make_index_sequence<N>{});
+}
+
+template <size_t N, detail::floating T>
+[[nodiscard]] constexpr Vector<N, T> lower(const IntervalVector<N, T>& v) noexcept {
+    return [&]<size_t... Is>(std::index_sequence<Is...>) {
+        return Vector<N, T>{v[Is].lo...};
+    }(std::make_index_sequence<N>{});
+}
+
+template <size_t N, detail::floating T>
+[[nodiscard]] constexpr Vector<N, T> upper(const IntervalVector<N, T>& v) noexcept {
+    return [&]<size_t... Is>(std::index_sequence<Is...>) {
+        return Vector<N, T>{v[Is].hi...};
+    }(std::make_index_sequence<N>{});
+}
+
+
+static_assert(detail::bitwise_copyable<IntervalVector<3, double>>);
@@ -0,0 +1,231 @@
+#pragma once
+
+
+#include <cstdint>
+
+#include <concepts>
+#include <span>
+#include <vector>
+
+#if defined(__BMI2__)
+    #include <immintrin.h>
+#endif
+
+#include "Vector.h"
+#include "parallel.h"
+#include "radix_sort.h"
+
+
+namespace detail {
+    template <typename T>
+    concept curve_coordinate = unsigned_integral<T> && !std::same_as<std::remove_cv_t<T>, bool>;
+
+    // every N-th bit starting at bit 0
+    template <size_t N>
+    constexpr uint64_t lane_mask = N == 2 ? 0x5555555555555555 : N == 3 ? 0x1249249249249249 : 0x1111111111111111;
+
+
+    // inserts N - 1 zero bits between the low 64 / N bits of x
+    template <size_t N>
+    [[nodiscard]] constexpr uint64_t spread_bits(uint64_t x) noexcept {
+        if constexpr (N == 2) {
+            x &= 0xffffffff;
+            x = (x | x << 16) & 0x0000ffff0000ffff;
+            x = (x | x << 8) & 0x00ff00ff00ff00ff;
+            x = (x | x << 4) & 0x0f0f0f0f0f0f0f0f;
+            x = (x | x << 2) & 0x3333333333333333;
+            x = (x | x << 1) & 0x5555555555555555;
+        } else if constexpr (N == 3) {
+            x &= 0x1fffff;
+            x = (x | x << 32) & 0x001f00000000ffff;
+            x = (x | x << 16) & 0x001f0000ff0000ff;
+            x = (x | x << 8) & 0x100f00f00f00f00f;
+            x = (x | x << 4) & 0x10c30c30c30c30c3;
+            x = (x | x << 2) & 0x1249249249249249;
+        } else {
+            x &= 0xffff;
+            x = (x | x << 24) & 0x000000ff000000ff;
+            x = (x | x << 12) & 0x000f000f000f000f;
+            x = (x | x << 6) & 0x0303030303030303;
+            x = (x | x << 3) & 0x1111111111111111;
+        }
+        return x;
+    }
+
+    // inverse of spread_bits, gathers every N-th bit starting at bit 0
+    template <size_t N>
+    [[nodiscard]] constexpr uint64_t compact_bits(uint64_t x) noexcept {
+        if constexpr (N == 2) {
+            x &= 0x5555555555555555;
+            x = (x | x >> 1) & 0x3333333333333333;
+            x = (x | x >> 2) & 0x0f0f0f0f0f0f0f0f;
+            x = (x | x >> 4) & 0x00ff00ff00ff00ff;
+            x = (x | x >> 8) & 0x0000ffff0000ffff;
+            x = (x | x >> 16) & 0x00000000ffffffff;
+        } else if constexpr (N == 3) {
+            x &= 0x1249249249249249;
+            x = (x | x >> 2) & 0x10c30c30c30c30c3;
+            x = (x | x >> 4) & 0x100f00f00f00f00f;
+            x = (x | x >> 8) & 0x001f0000ff0000ff;
+            x = (x | x >> 16) & 0x001f00000000ffff;
+            x = (x | x >> 32) & 0x00000000001fffff;
+        } else {
+            x &= 0x1111111111111111;
+            x = (x | x >> 3) & 0x0303030303030303;
+            x = (x | x >> 6) & 0x000f000f000f000f;
+            x = (x | x >> 12) & 0x000000ff000000ff;
+            x = (x | x >> 24) & 0x000000000000ffff;
+        }
+        return x;
+    }
+
+    // lane i of the result is taken from bit positions i, i + N, i + 2N, ... of code
+    template <size_t N, size_t I>
+    [[nodiscard]] constexpr uint64_t deinterleave(uint64_t code) noexcept {
+#if defined(__BMI2__)
+        if !consteval {
+            return _pext_u64(code, lane_mask<N> << I);
+        }
+#endif
+        return compact_bits<N>(code >> I);
+    }
+
+    template <size_t N, size_t I>
+    [[nodiscard]] constexpr uint64_t interleave(uint64_t lane) noexcept {
+#if defined(__BMI2__)
+        if !consteval {
+            return _pdep_u64(lane, lane_mask<N> << I);
+        }
+#endif
+        return spread_bits<N>(lane) << I;
+    }
+
+
+    // Skilling's transform between axes and the transposed Hilbert index, on the low bits of every lane
+    template <size_t N>
+    constexpr void axes_to_transpose(uint64_t (&x)[N], size_t bits) noexcept {
+        for (uint64_t q = uint64_t{1} << (bits - 1); q > 1; q >>= 1) {
+            const uint64_t p = q - 1;
+            for (size_t i = 0; i < N; i++) {
+                if (x[i] & q) {
+                    x[0] ^= p;
+                } else {
+                    const uint64_t t = (x[0] ^ x[i]) & p;
+                    x[0] ^= t;
+                    x[i] ^= t;
+                }
+            }
+        }
+        // gray encode
+        for (size_t i = 1; i < N; i++) {
+            x[i] ^= x[i - 1];
+        }
+        uint64_t t = 0;
+        for (uint64_t q = uint64_t{1} << (bits - 1); q > 1; q >>= 1) {
+            if (x[N - 1] & q) {
+                t ^= q - 1;
+            }
+        }
+        for (size_t i = 0; i < N; i++) {
+            x[i] ^= t;
+        }
+    }
+
+    template <size_t N>
+    constexpr void transpose_to_axes(uint64_t (&x)[N], size_t bits) noexcept {
+        // gray decode
+        const uint64_t t = x[N - 1] >> 1;
+        for (size_t i = N - 1; i > 0; i--) {
+            x[i] ^= x[i - 1];
+        }
+        x[0] ^= t;
+        for (uint64_t q = 2; q != uint64_t{1} << bits; q <<= 1) {
+            const uint64_t p = q - 1;
+            for (size_t i = N; i-- > 0;) {
+                if (x[i] & q) {
+                    x[0] ^= p;
+                } else {
+                    const uint64_t s = (x[0] ^ x[i]) & p;
+                    x[0] ^= s;
+                    x[i] ^= s;
+                }
+            }
+        }
+    }
+}// namespace detail
+
+
+// bits per lane that fit in a 64-bit key
+template <size_t N>
+constexpr size_t morton_bits = 64 / N;
+
+
+// Z-order key, bit k of lane i lands at bit k * N + i; lanes are truncated to morton_bits<N> bits
+template <size_t N, detail::curve_coordinate T>
+[[nodiscard]] constexpr uint64_t morton_encode(const Vector<N, T>& v) noexcept {
+    return [&]<size_t... Is>(std::index_sequence<Is...>) {
+        return (detail::interleave<N, Is>(v[Is]) | ...);
+    }(std::make_index_sequence<N>{});
+}
+
+template <size_t N, detail::curve_coordinate T>
+[[nodiscard]] constexpr Vector<N, T> morton_decode(uint64_t code) noexcept {
+    return [&]<size_t... Is>(std::index_sequence<Is...>) {
+        return Vector<N, T>{static_cast<T>(detail::deinterleave<N, Is>(code))...};
+    }(std::make_index_sequence<N>{});
+}
+
+
+// Hilbert key over the low bits of every lane, bits <= morton_bits<N>
+// consecutive keys are always neighboring cells, unlike Z-order which jumps at every power of two
+template <size_t N, detail::curve_coordinate T>
+[[nodiscard]] constexpr uint64_t hilbert_encode(const Vector<N, T>& v, size_t bits = morton_bits<N>) noexcept {
+    return [&]<size_t... Is>(std::index_sequence<Is...>) {
+        uint64_t x[N]{(v[Is] & ((uint64_t{1} << bits) - 1))...};
+        detail::axes_to_transpose(x, bits);
+        // lane 0 holds the most significant bit of every group of N
+        return (detail::interleave<N, N - 1 - Is>(x[Is]) | ...);
+    }(std::make_index_sequence<N>{});
+}
+
+template <size_t N, detail::curve_coordinate T>
+[[nodiscard]] constexpr Vector<N, T> hilbert_decode(uint64_t code, size_t bits = morton_bits<N>) noexcept {
+    return [&]<size_t... Is>(std::index_sequence<Is...>) {
+        uint64_t x[N]{detail::deinterleave<N, N - 1 - Is>(code)...};
+        detail::transpose_to_axes(x, bits);
+        return Vector<N, T>{static_cast<T>(x[Is])...};
+    }(std::make_index_sequence<N>{});
+}
+
+
+// batch versions, spread over threads (0 = all hardware threads)
+enum class curve : uint8_t {
+    morton,
+    hilbert
+};
+
+template <curve C = curve::morton, size_t N, detail::curve_coordinate T>
+void curve_encode(std::span<const Vector<N, T>> in, std::span<uint64_t> out, size_t threads = 1) {
+    detail::parallel_chunks(in.size(), detail::chunk_count(in.size(), threads, 1 << 14), [&](size_t, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            out[i] = C == curve::morton ? morton_encode(in[i]) : hilbert_encode(in[i]);
+        }
+    });
+}
+
+template <curve C = curve::morton, size_t N, detail::curve_coordinate T>
+void curve_decode(std::span<const uint64_t> in, std::span<Vector<N, T>> out, size_t threads = 1) {
+    detail::parallel_chunks(in.size(), detail::chunk_count(in.size(), threads, 1 << 14), [&](size_t, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            out[i] = C == curve::morton ? morton_decode<N, T>(in[i]) : hilbert_decode<N, T>(in[i]);
+        }
+    });
+}
+
+// reorders points along the curve with a parallel radix sort of their keys
+template <curve C = curve::morton, size_t N, detail::curve_coordinate T>
+void sort_by_curve(std::span<Vector<N, T>> points, size_t threads = 1) {
+    std::vector<uint64_t> keys(points.size());
+    curve_encode<C>(std::span<const Vector<N, T>>(points), std::span(keys), threads);
+    radix_sort_by_key(std::span(keys), points, threads);
+}
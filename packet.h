@@ -0,0 +1,548 @@
+#pragma once
+
+
+#include <cmath>
+
+#include <algorithm>
+#include <bit>
+#include <functional>
+#include <span>
+#include <type_traits>
+
+#include "Vector.h"
+#include "dispatch.h"
+
+
+// K scalars processed side by side, one register (or a few) per group
+// as an element type it turns Vector<3, Lanes<float, 16>> into 16 Vector<3, float> stored component-wise in three zmm
+// registers: every operator, geometric function and swizzle of the library applies to all 16 at once, swizzles
+// only pick other registers. comparisons and logical operators are lane-wise and give Lanes<bool, K> masks,
+// v < w is one mask per component and (v < w).all() one per lane; any_lane/all_lanes reduce a mask and select blends
+template <typename T, size_t K>
+    requires((detail::integral<T> || detail::floating<T>) && K > 0)
+struct alignas(std::min<size_t>(std::bit_ceil(K * sizeof(T)), 64)) Lanes {
+    using value_type = T;
+    static constexpr size_t width = K;
+    using mask_type = Lanes<bool, K>;
+
+
+    T lane[K];// no initializers, Vector's unions need a trivial default constructor
+
+
+    constexpr Lanes() noexcept = default;
+
+    // broadcast
+    template <typename U>
+        requires(detail::integral<U> || detail::floating<U>)
+    constexpr Lanes(U x) noexcept {
+        std::fill_n(lane, K, static_cast<T>(x));
+    }
+
+    // narrowing is explicit so mixed-precision operators only match the wider type's friends
+    template <typename U>
+        requires(!std::is_same_v<U, T>)
+    constexpr explicit(sizeof(U) > sizeof(T)) Lanes(const Lanes<U, K>& l) noexcept {
+        for (size_t k = 0; k < K; k++) {
+            lane[k] = static_cast<T>(l.lane[k]);
+        }
+    }
+
+
+    [[nodiscard]] constexpr T& operator[](size_t k) noexcept {
+        return lane[k];
+    }
+
+    [[nodiscard]] constexpr T operator[](size_t k) const noexcept {
+        return lane[k];
+    }
+
+
+    [[nodiscard]] constexpr Lanes operator+() const noexcept {
+        return *this;
+    }
+
+    [[nodiscard]] constexpr Lanes operator-() const noexcept {
+        return map([](T x) -> T { return -x; });
+    }
+
+    [[nodiscard]] constexpr Lanes operator~() const noexcept
+        requires detail::integral<T>
+    {
+        return map([](T x) -> T { return ~x; });
+    }
+
+    [[nodiscard]] constexpr mask_type operator!() const noexcept {
+        return map([](T x) { return !x; });
+    }
+
+    constexpr Lanes& operator++() noexcept {
+        return *this += T{1};
+    }
+
+    constexpr Lanes& operator--() noexcept {
+        return *this -= T{1};
+    }
+
+    constexpr Lanes operator++(int) noexcept {
+        const Lanes tmp = *this;
+        ++*this;
+        return tmp;
+    }
+
+    constexpr Lanes operator--(int) noexcept {
+        const Lanes tmp = *this;
+        --*this;
+        return tmp;
+    }
+
+    constexpr Lanes& operator+=(const Lanes& r) noexcept {
+        return *this = *this + r;
+    }
+
+    constexpr Lanes& operator-=(const Lanes& r) noexcept {
+        return *this = *this - r;
+    }
+
+    constexpr Lanes& operator*=(const Lanes& r) noexcept {
+        return *this = *this * r;
+    }
+
+    constexpr Lanes& operator/=(const Lanes& r) noexcept {
+        return *this = *this / r;
+    }
+
+    constexpr Lanes& operator%=(const Lanes& r) noexcept
+        requires detail::integral<T>
+    {
+        return *this = *this % r;
+    }
+
+    constexpr Lanes& operator&=(const Lanes& r) noexcept
+        requires detail::integral<T>
+    {
+        return *this = *this & r;
+    }
+
+    constexpr Lanes& operator|=(const Lanes& r) noexcept
+        requires detail::integral<T>
+    {
+        return *this = *this | r;
+    }
+
+    constexpr Lanes& operator^=(const Lanes& r) noexcept
+        requires detail::integral<T>
+    {
+        return *this = *this ^ r;
+    }
+
+    constexpr Lanes& operator<<=(const Lanes& r) noexcept
+        requires detail::integral<T>
+    {
+        return *this = *this << r;
+    }
+
+    constexpr Lanes& operator>>=(const Lanes& r) noexcept
+        requires detail::integral<T>
+    {
+        return *this = *this >> r;
+    }
+
+
+    // f applied to every lane, the lane type follows f's result
+    template <typename F>
+    [[nodiscard]] constexpr auto map(const F& f) const noexcept {
+        Lanes<std::invoke_result_t<const F&, T>, K> r;
+        for (size_t k = 0; k < K; k++) {
+            r.lane[k] = f(lane[k]);
+        }
+        return r;
+    }
+
+    // f applied to every pair of lanes
+    template <typename F>
+    [[nodiscard]] constexpr auto zip(const Lanes& other, const F& f) const noexcept {
+        Lanes<std::invoke_result_t<const F&, T, T>, K> r;
+        for (size_t k = 0; k < K; k++) {
+            r.lane[k] = f(lane[k], other.lane[k]);
+        }
+        return r;
+    }
+
+
+    // hidden friends, scalars are broadcast by the converting constructor
+    [[nodiscard]] friend constexpr Lanes operator+(const Lanes& l, const Lanes& r) noexcept {
+        Lanes d;
+        for (size_t k = 0; k < K; k++) {
+            d.lane[k] = l.lane[k] + r.lane[k];
+        }
+        return d;
+    }
+
+    [[nodiscard]] friend constexpr Lanes operator-(const Lanes& l, const Lanes& r) noexcept {
+        Lanes d;
+        for (size_t k = 0; k < K; k++) {
+            d.lane[k] = l.lane[k] - r.lane[k];
+        }
+        return d;
+    }
+
+    [[nodiscard]] friend constexpr Lanes operator*(const Lanes& l, const Lanes& r) noexcept {
+        Lanes d;
+        for (size_t k = 0; k < K; k++) {
+            d.lane[k] = l.lane[k] * r.lane[k];
+        }
+        return d;
+    }
+
+    [[nodiscard]] friend constexpr Lanes operator/(const Lanes& l, const Lanes& r) noexcept {
+        Lanes d;
+        for (size_t k = 0; k < K; k++) {
+            d.lane[k] = l.lane[k] / r.lane[k];
+        }
+        return d;
+    }
+
+    [[nodiscard]] friend constexpr Lanes operator%(const Lanes& l, const Lanes& r) noexcept
+        requires detail::integral<T>
+    {
+        return l.zip(r, [](T a, T b) -> T { return a % b; });
+    }
+
+    [[nodiscard]] friend constexpr Lanes operator&(const Lanes& l, const Lanes& r) noexcept
+        requires detail::integral<T>
+    {
+        return l.zip(r, [](T a, T b) -> T { return a & b; });
+    }
+
+    [[nodiscard]] friend constexpr Lanes operator|(const Lanes& l, const Lanes& r) noexcept
+        requires detail::integral<T>
+    {
+        return l.zip(r, [](T a, T b) -> T { return a | b; });
+    }
+
+    [[nodiscard]] friend constexpr Lanes operator^(const Lanes& l, const Lanes& r) noexcept
+        requires detail::integral<T>
+    {
+        return l.zip(r, [](T a, T b) -> T { return a ^ b; });
+    }
+
+    [[nodiscard]] friend constexpr Lanes operator<<(const Lanes& l, const Lanes& r) noexcept
+        requires detail::integral<T>
+    {
+        return l.zip(r, [](T a, T b) -> T { return a << b; });
+    }
+
+    [[nodiscard]] friend constexpr Lanes operator>>(const Lanes& l, const Lanes& r) noexcept
+        requires detail::integral<T>
+    {
+        return l.zip(r, [](T a, T b) -> T { return a >> b; });
+    }
+
+
+    // lane-wise, both operands are always evaluated
+    [[nodiscard]] friend constexpr mask_type operator&&(const Lanes& l, const Lanes& r) noexcept {
+        return l.zip(r, [](T a, T b) { return a && b; });
+    }
+
+    [[nodiscard]] friend constexpr mask_type operator||(const Lanes& l, const Lanes& r) noexcept {
+        return l.zip(r, [](T a, T b) { return a || b; });
+    }
+
+
+    [[nodiscard]] friend constexpr mask_type operator==(const Lanes& l, const Lanes& r) noexcept {
+        return l.zip(r, [](T a, T b) { return a == b; });
+    }
+
+    [[nodiscard]] friend constexpr mask_type operator!=(const Lanes& l, const Lanes& r) noexcept {
+        return l.zip(r, [](T a, T b) { return a != b; });
+    }
+
+    [[nodiscard]] friend constexpr mask_type operator<(const Lanes& l, const Lanes& r) noexcept {
+        return l.zip(r, [](T a, T b) { return a < b; });
+    }
+
+    [[nodiscard]] friend constexpr mask_type operator<=(const Lanes& l, const Lanes& r) noexcept {
+        return l.zip(r, [](T a, T b) { return a <= b; });
+    }
+
+    [[nodiscard]] friend constexpr mask_type operator>(const Lanes& l, const Lanes& r) noexcept {
+        return l.zip(r, [](T a, T b) { return a > b; });
+    }
+
+    [[nodiscard]] friend constexpr mask_type operator>=(const Lanes& l, const Lanes& r) noexcept {
+        return l.zip(r, [](T a, T b) { return a >= b; });
+    }
+};
+
+
+// whether any or every lane of a mask is set
+template <size_t K>
+[[nodiscard]] constexpr bool any_lane(const Lanes<bool, K>& m) noexcept {
+    return std::ranges::any_of(m.lane, std::identity{});
+}
+
+template <size_t K>
+[[nodiscard]] constexpr bool all_lanes(const Lanes<bool, K>& m) noexcept {
+    return std::ranges::all_of(m.lane, std::identity{});
+}
+
+// lane k of a where m is set, of b elsewhere
+template <typename T, size_t K>
+[[nodiscard]] constexpr Lanes<T, K> select(const Lanes<bool, K>& m, const Lanes<T, K>& a, const Lanes<T, K>& b) noexcept {
+    Lanes<T, K> r;
+    for (size_t k = 0; k < K; k++) {
+        r.lane[k] = m.lane[k] ? a.lane[k] : b.lane[k];
+    }
+    return r;
+}
+
+
+namespace detail {
+    template <typename T, size_t K>
+    constexpr bool is_lanes_v<Lanes<T, K>> = true;
+
+    // cast<float> on a lane group converts every lane
+    template <typename U, size_t K, typename T>
+        requires(integral<T> || floating<T>)
+    struct cast_type<Lanes<U, K>, T> {
+        using type = Lanes<T, K>;
+    };
+
+    // one 64-byte register per component, split into two or four on narrower instruction sets
+    template <typename T>
+    constexpr size_t packet_width = 64 / sizeof(T);
+}// namespace detail
+
+
+// K Vector<N, T> transposed, component i of Vector k is p[i][k]
+template <size_t N, typename T, size_t K = detail::packet_width<T>>
+using Packet = Vector<N, Lanes<T, K>>;
+
+
+// math functions, found by Vector's members through ADL
+template <typename T, size_t K>
+[[nodiscard]] constexpr Lanes<T, K> abs(const Lanes<T, K>& x) noexcept {
+    if constexpr (std::is_unsigned_v<T>) {
+        return x;
+    } else if constexpr (detail::floating<T>) {
+        // clears the sign bit, also of -0 and NaN like std::abs
+        return x.map([](T e) -> T { return std::abs(e); });
+    } else {
+        return x.map([](T e) -> T { return e < 0 ? -e : e; });
+    }
+}
+
+template <typename T, size_t K>
+[[nodiscard]] Lanes<T, K> sqrt(const Lanes<T, K>& x) noexcept {
+    return x.map([](T e) -> T { return std::sqrt(e); });
+}
+
+template <typename T, size_t K>
+[[nodiscard]] Lanes<T, K> cbrt(const Lanes<T, K>& x) noexcept {
+    return x.map([](T e) -> T { return std::cbrt(e); });
+}
+
+template <typename T, size_t K>
+[[nodiscard]] Lanes<T, K> exp(const Lanes<T, K>& x) noexcept {
+    return x.map([](T e) -> T { return std::exp(e); });
+}
+
+template <typename T, size_t K>
+[[nodiscard]] Lanes<T, K> exp2(const Lanes<T, K>& x) noexcept {
+    return x.map([](T e) -> T { return std::exp2(e); });
+}
+
+template <typename T, size_t K>
+[[nodiscard]] Lanes<T, K> expm1(const Lanes<T, K>& x) noexcept {
+    return x.map([](T e) -> T { return std::expm1(e); });
+}
+
+template <typename T, size_t K>
+[[nodiscard]] Lanes<T, K> log(const Lanes<T, K>& x) noexcept {
+    return x.map([](T e) -> T { return std::log(e); });
+}
+
+template <typename T, size_t K>
+[[nodiscard]] Lanes<T, K> log10(const Lanes<T, K>& x) noexcept {
+    return x.map([](T e) -> T { return std::log10(e); });
+}
+
+template <typename T, size_t K>
+[[nodiscard]] Lanes<T, K> log2(const Lanes<T, K>& x) noexcept {
+    return x.map([](T e) -> T { return std::log2(e); });
+}
+
+template <typename T, size_t K>
+[[nodiscard]] Lanes<T, K> log1p(const Lanes<T, K>& x) noexcept {
+    return x.map([](T e) -> T { return std::log1p(e); });
+}
+
+template <typename T, size_t K>
+[[nodiscard]] Lanes<T, K> sin(const Lanes<T, K>& x) noexcept {
+    return x.map([](T e) -> T { return std::sin(e); });
+}
+
+template <typename T, size_t K>
+[[nodiscard]] Lanes<T, K> cos(const Lanes<T, K>& x) noexcept {
+    return x.map([](T e) -> T { return std::cos(e); });
+}
+
+template <typename T, size_t K>
+[[nodiscard]] Lanes<T, K> tan(const Lanes<T, K>& x) noexcept {
+    return x.map([](T e) -> T { return std::tan(e); });
+}
+
+template <typename T, size_t K>
+[[nodiscard]] Lanes<T, K> asin(const Lanes<T, K>& x) noexcept {
+    return x.map([](T e) -> T { return std::asin(e); });
+}
+
+template <typename T, size_t K>
+[[nodiscard]] Lanes<T, K> acos(const Lanes<T, K>& x) noexcept {
+    return x.map([](T e) -> T { return std::acos(e); });
+}
+
+template <typename T, size_t K>
+[[nodiscard]] Lanes<T, K> atan(const Lanes<T, K>& x) noexcept {
+    return x.map([](T e) -> T { return std::atan(e); });
+}
+
+template <typename T, size_t K>
+[[nodiscard]] Lanes<T, K> sinh(const Lanes<T, K>& x) noexcept {
+    return x.map([](T e) -> T { return std::sinh(e); });
+}
+
+template <typename T, size_t K>
+[[nodiscard]] Lanes<T, K> cosh(const Lanes<T, K>& x) noexcept {
+    return x.map([](T e) -> T { return std::cosh(e); });
+}
+
+template <typename T, size_t K>
+[[nodiscard]] Lanes<T, K> tanh(const Lanes<T, K>& x) noexcept {
+    return x.map([](T e) -> T { return std::tanh(e); });
+}
+
+template <typename T, size_t K>
+[[nodiscard]] Lanes<T, K> asinh(const Lanes<T, K>& x) noexcept {
+    return x.map([](T e) -> T { return std::asinh(e); });
+}
+
+template <typename T, size_t K>
+[[nodiscard]] Lanes<T, K> acosh(const Lanes<T, K>& x) noexcept {
+    return x.map([](T e) -> T { return std::acosh(e); });
+}
+
+template <typename T, size_t K>
+[[nodiscard]] Lanes<T, K> atanh(const Lanes<T, K>& x) noexcept {
+    return x.map([](T e) -> T { return std::atanh(e); });
+}
+
+template <typename T, size_t K>
+[[nodiscard]] Lanes<T, K> erf(const Lanes<T, K>& x) noexcept {
+    return x.map([](T e) -> T { return std::erf(e); });
+}
+
+template <typename T, size_t K>
+[[nodiscard]] Lanes<T, K> erfc(const Lanes<T, K>& x) noexcept {
+    return x.map([](T e) -> T { return std::erfc(e); });
+}
+
+template <typename T, size_t K>
+[[nodiscard]] Lanes<T, K> tgamma(const Lanes<T, K>& x) noexcept {
+    return x.map([](T e) -> T { return std::tgamma(e); });
+}
+
+template <typename T, size_t K>
+[[nodiscard]] Lanes<T, K> lgamma(const Lanes<T, K>& x) noexcept {
+    return x.map([](T e) -> T { return std::lgamma(e); });
+}
+
+template <typename T, size_t K>
+[[nodiscard]] Lanes<T, K> ceil(const Lanes<T, K>& x) noexcept {
+    return x.map([](T e) -> T { return std::ceil(e); });
+}
+
+template <typename T, size_t K>
+[[nodiscard]] Lanes<T, K> floor(const Lanes<T, K>& x) noexcept {
+    return x.map([](T e) -> T { return std::floor(e); });
+}
+
+template <typename T, size_t K>
+[[nodiscard]] Lanes<T, K> trunc(const Lanes<T, K>& x) noexcept {
+    return x.map([](T e) -> T { return std::trunc(e); });
+}
+
+template <typename T, size_t K>
+[[nodiscard]] Lanes<T, K> round(const Lanes<T, K>& x) noexcept {
+    return x.map([](T e) -> T { return std::round(e); });
+}
+
+
+template <typename T, size_t K>
+[[nodiscard]] Lanes<T, K> pow(const Lanes<T, K>& x, const Lanes<T, K>& y) noexcept {
+    return x.zip(y, [](T a, T b) -> T { return std::pow(a, b); });
+}
+
+template <typename T, size_t K>
+[[nodiscard]] Lanes<T, K> hypot(const Lanes<T, K>& x, const Lanes<T, K>& y) noexcept {
+    return x.zip(y, [](T a, T b) -> T { return std::hypot(a, b); });
+}
+
+template <typename T, size_t K>
+[[nodiscard]] Lanes<T, K> atan2(const Lanes<T, K>& x, const Lanes<T, K>& y) noexcept {
+    return x.zip(y, [](T a, T b) -> T { return std::atan2(a, b); });
+}
+
+
+// transposes in[first .. first + K) into a packet; lanes past the end of in repeat its last Vector,
+// so a kernel never sees values (such as zero divisors) that are not in the input
+template <size_t K, size_t N, typename T>
+[[nodiscard]] constexpr Packet<N, T, K> load_packet(std::span<const Vector<N, T>> in, size_t first) noexcept {
+    Packet<N, T, K> p;
+    if (first >= in.size()) {
+        return p;
+    }
+    for (size_t k = 0; k < K; k++) {
+        const Vector<N, T>& v = in[std::min(first + k, in.size() - 1)];
+        for (size_t i = 0; i < N; i++) {
+            p[i].lane[k] = v[i];
+        }
+    }
+    return p;
+}
+
+// transposes a packet back into out[first .. first + K), as far as out reaches
+template <size_t N, typename T, size_t K>
+constexpr void store_packet(const Packet<N, T, K>& p, std::span<Vector<N, T>> out, size_t first) noexcept {
+    const size_t count = first < out.size() ? std::min(K, out.size() - first) : 0;
+    for (size_t k = 0; k < count; k++) {
+        for (size_t i = 0; i < N; i++) {
+            out[first + k][i] = p[i].lane[k];
+        }
+    }
+}
+
+// Vector k of the packet
+template <size_t N, typename T, size_t K>
+[[nodiscard]] constexpr Vector<N, T> extract(const Packet<N, T, K>& p, size_t k) noexcept {
+    return [&]<size_t... Is>(std::index_sequence<Is...>) {
+        return Vector<N, T>{p[Is].lane[k]...};
+    }(std::make_index_sequence<N>{});
+}
+
+
+// out[i] = f(in[i]) with f written once in Vector style and called with Packet<N, T, K>, e.g.
+// packet_map(in, out, [](const auto& v) { return normalize(v) * 2.f; });
+// K Vectors per call, compiled for the active instruction set; out must hold at least in.size() elements
+// f may change the element type, v.cast<double>() on float input gives the Packet<N, double, K> that double out expects
+template <size_t K = 0, size_t N, typename T, size_t M, typename U, typename F,
+          size_t W = K ? K : detail::packet_width<T>>
+    requires std::convertible_to<std::invoke_result_t<const F&, Packet<N, T, W>>, Packet<M, U, W>>
+void packet_map(std::span<const Vector<N, T>> in, std::span<Vector<M, U>> out, const F& f) {
+    detail::dispatch([&] {
+        for (size_t first = 0; first < in.size(); first += W) {
+            const Packet<M, U, W> r = f(load_packet<W>(in, first));
+            store_packet(r, out.first(in.size()), first);
+        }
+    });
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+
+namespace detail {
+    // threads == 0 selects every hardware thread
+    [[nodiscard]] inline size_t thread_count(size_t threads) noexcept {
+        return threads ? threads : std::max<size_t>(1, std::thread::hardware_concurrency());
+    }
+
+    // number of chunks [0, n) is split into: at most thread_count(threads), each at least grain elements
+    [[nodiscard]] inline size_t chunk_count(size_t n, size_t threads, size_t grain) noexcept {
+        return std::clamp<size_t>(n / std::max<size_t>(grain, 1), 1, thread_count(threads));
+    }
+
+    // runs f(chunk, begin, end) for every chunk of [0, n), the calling thread takes chunk 0
+    // chunk boundaries only depend on n and chunks, never on scheduling
+    void parallel_chunks(size_t n, size_t chunks, const auto& f) {
+        if (chunks <= 1) {
+            f(size_t{0}, size_t{0}, n);
+            return;
+        }
+        std::vector<std::jthread> workers;
+        workers.reserve(chunks - 1);
+        for (size_t c = 1; c < chunks; c++) {
+            workers.emplace_back([&f, n, chunks, c] { f(c, n * c / chunks, n * (c + 1) / chunks); });
+        }
+        f(size_t{0}, size_t{0}, n / chunks);
+    }
+
+    // runs f(b, begin, end) for every block [b * block, min((b + 1) * block, n)), blocks spread over threads (0 = all hardware threads)
+    // unlike parallel_chunks the boundaries never depend on the thread count, so per-block results can be combined reproducibly
+    void parallel_blocks(size_t n, size_t block, size_t threads, const auto& f) {
+        const size_t blocks = (n + block - 1) / block;
+        parallel_chunks(blocks, std::min(blocks, thread_count(threads)), [&](size_t, size_t first, size_t last) {
+            for (size_t b = first; b < last; b++) {
+                f(b, b * block, std::min(n, (b + 1) * block));
+            }
+        });
+    }
+}// namespace detail
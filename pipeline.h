@@ -0,0 +1,214 @@
+#pragma once
+
+
+#include <algorithm>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "dispatch.h"
+
+
+namespace detail {
+    // bounded ring of chunks between two stage threads, push blocks while full and pop while empty
+    // close() wakes both sides: pop drains what is left and then returns nullopt, push fails right away
+    template <typename T>
+    class channel {
+    public:
+        explicit channel(size_t capacity) : ring(std::max<size_t>(capacity, 1)) {}
+
+
+        bool push(T&& v) {
+            std::unique_lock lock(m);
+            not_full.wait(lock, [&] { return closed || count < ring.size(); });
+            if (closed) {
+                return false;
+            }
+            ring[(head + count) % ring.size()].emplace(std::move(v));
+            count++;
+            not_empty.notify_one();
+            return true;
+        }
+
+        std::optional<T> pop() {
+            std::unique_lock lock(m);
+            not_empty.wait(lock, [&] { return closed || count > 0; });
+            if (count == 0) {
+                return std::nullopt;
+            }
+            std::optional<T> v = std::move(ring[head]);
+            ring[head].reset();
+            head = (head + 1) % ring.size();
+            count--;
+            not_full.notify_one();
+            return v;
+        }
+
+        void close() {
+            {
+                std::lock_guard lock(m);
+                closed = true;
+            }
+            not_full.notify_all();
+            not_empty.notify_all();
+        }
+
+    private:
+        std::mutex m;
+        std::condition_variable not_full, not_empty;
+        std::vector<std::optional<T>> ring;
+        size_t head = 0, count = 0;
+        bool closed = false;
+    };
+
+
+    // first exception thrown by any stage, rethrown by Pipeline::run
+    struct pipeline_state {
+        std::mutex m;
+        std::exception_ptr error;
+
+        void fail(std::exception_ptr e) {
+            std::lock_guard lock(m);
+            if (!error) {
+                error = std::move(e);
+            }
+        }
+    };
+}// namespace detail
+
+
+// source -> stages -> sink over chunks, every stage on its own thread so parsing, transforming and writing overlap
+// neighbouring stages share a ring of depth chunks (2 = double buffering), so at most depth + 1 chunks per stage are alive
+// whatever the length of the stream; a throwing stage stops the stream in both directions and run() rethrows
+template <typename T>
+class Pipeline {
+    template <typename U>
+    friend class Pipeline;
+
+public:
+    // source() returns std::optional<T>, nullopt ends the stream
+    template <typename Source>
+        requires std::is_same_v<std::invoke_result_t<Source&>, std::optional<T>>
+    explicit Pipeline(Source source, size_t depth = 2) : Pipeline(std::make_shared<detail::pipeline_state>(), depth) {
+        threads.emplace_back([state = state, out = out, source = std::move(source)]() mutable {
+            try {
+                while (std::optional<T> chunk = source()) {
+                    if (!out->push(std::move(*chunk))) {
+                        break;
+                    }
+                }
+            } catch (...) {
+                state->fail(std::current_exception());
+            }
+            out->close();
+        });
+    }
+
+    Pipeline(Pipeline&&) noexcept = default;
+
+    // an abandoned pipeline unblocks its threads before joining them
+    ~Pipeline() {
+        if (out) {
+            out->close();
+        }
+    }
+
+
+    // appends a stage running f(T&&) on its own thread
+    template <typename F>
+    [[nodiscard]] auto then(F f) && {
+        using U = std::invoke_result_t<F&, T&&>;
+        Pipeline<U> next(state, depth);
+        next.threads = std::move(threads);
+        next.threads.emplace_back([state = state, in = std::move(out), out = next.out, f = std::move(f)]() mutable {
+            try {
+                while (std::optional<T> chunk = in->pop()) {
+                    if (!out->push(f(std::move(*chunk)))) {
+                        break;
+                    }
+                }
+            } catch (...) {
+                state->fail(std::current_exception());
+            }
+            in->close();
+            out->close();
+        });
+        return next;
+    }
+
+    // feeds every chunk to sink(T&&) on the calling thread, then joins the stages
+    template <typename F>
+    void run(F sink) && {
+        const auto in = std::move(out);
+        try {
+            while (std::optional<T> chunk = in->pop()) {
+                sink(std::move(*chunk));
+            }
+        } catch (...) {
+            state->fail(std::current_exception());
+        }
+        in->close();
+        threads.clear();
+        if (state->error) {
+            std::rethrow_exception(state->error);
+        }
+    }
+
+private:
+    Pipeline(std::shared_ptr<detail::pipeline_state> state, size_t depth) : state(std::move(state)), out(std::make_shared<detail::channel<T>>(depth)), depth(depth) {}
+
+
+    std::shared_ptr<detail::pipeline_state> state;
+    std::shared_ptr<detail::channel<T>> out;
+    size_t depth;
+    std::vector<std::jthread> threads;// last member, joined first
+};
+
+template <typename Source>
+Pipeline(Source, size_t = 2) -> Pipeline<typename std::invoke_result_t<Source&>::value_type>;
+
+
+// source handing out copies of data in chunks of chunk elements
+template <typename E>
+[[nodiscard]] auto chunked(std::span<const E> data, size_t chunk) {
+    return [data, chunk, offset = size_t{0}]() mutable -> std::optional<std::vector<E>> {
+        if (offset >= data.size()) {
+            return std::nullopt;
+        }
+        const auto part = data.subspan(offset, std::min(chunk, data.size() - offset));
+        offset += part.size();
+        return std::vector<E>(part.begin(), part.end());
+    };
+}
+
+// stage applying f to every element of a std::vector chunk, in place when f keeps the element type
+// e.g. elementwise([](const Vector<3, float>& v) { return v.cast<double>(); })
+template <typename F>
+[[nodiscard]] auto elementwise(F f) {
+    return [f = std::move(f)]<typename E>(std::vector<E>&& chunk) {
+        using R = std::invoke_result_t<const F&, const E&>;
+        if constexpr (std::is_same_v<R, E>) {
+            detail::dispatch([&] {
+                for (E& e : chunk) {
+                    e = f(e);
+                }
+            });
+            return std::move(chunk);
+        } else {
+            std::vector<R> out(chunk.size());
+            detail::dispatch([&] {
+                for (size_t i = 0; i < chunk.size(); i++) {
+                    out[i] = f(chunk[i]);
+                }
+            });
+            return out;
+        }
+    };
+}
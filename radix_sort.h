@@ -0,0 +1,65 @@
+#pragma once
+
+
+#include <algorithm>
+#include <array>
+#include <concepts>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include "parallel.h"
+
+
+// stable LSD radix sort of keys, values move along with their key
+// 8 bits per pass, a pass whose byte is the same in every key is skipped
+// every pass histograms and scatters per chunk on up to threads threads (0 = all hardware threads)
+template <std::unsigned_integral K, typename V>
+void radix_sort_by_key(std::span<K> keys, std::span<V> values, size_t threads = 1) {
+    const size_t n = keys.size();
+    const size_t chunks = detail::chunk_count(n, threads, 1 << 14);
+    std::vector<K> key_buffer(n);
+    std::vector<V> value_buffer(n);
+    std::vector<std::array<size_t, 256>> offsets(chunks);
+
+    K* ks = keys.data();
+    V* vs = values.data();
+    K* kd = key_buffer.data();
+    V* vd = value_buffer.data();
+    for (size_t shift = 0; shift < sizeof(K) * 8; shift += 8) {
+        detail::parallel_chunks(n, chunks, [&](size_t c, size_t begin, size_t end) {
+            offsets[c].fill(0);
+            for (size_t i = begin; i < end; i++) {
+                offsets[c][ks[i] >> shift & 0xff]++;
+            }
+        });
+
+        // digit-major, chunk-minor prefix sum keeps equal digits in input order
+        size_t sum = 0;
+        bool single = false;
+        for (size_t d = 0; d < 256; d++) {
+            const size_t first = sum;
+            for (size_t c = 0; c < chunks; c++) {
+                sum += std::exchange(offsets[c][d], sum);
+            }
+            single |= sum - first == n;
+        }
+        if (single) {
+            continue;
+        }
+
+        detail::parallel_chunks(n, chunks, [&](size_t c, size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) {
+                const size_t at = offsets[c][ks[i] >> shift & 0xff]++;
+                kd[at] = ks[i];
+                vd[at] = vs[i];
+            }
+        });
+        std::swap(ks, kd);
+        std::swap(vs, vd);
+    }
+    if (ks != keys.data()) {
+        std::copy_n(ks, n, keys.data());
+        std::copy_n(vs, n, values.data());
+    }
+}
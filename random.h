@@ -0,0 +1,230 @@
+#pragma once
+
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+#include <algorithm>
+#include <limits>
+#include <numbers>
+#include <span>
+#include <type_traits>
+#include <utility>
+
+#include "Vector.h"
+#include "parallel.h"
+
+
+namespace detail {
+    // Philox4x32-10 over count consecutive counters starting at first, in the given stream
+    // the rounds run on 8 counters side by side in lane arrays so they map onto packed 32x32->64 multiplies
+    inline void philox_blocks(const uint32_t (&key)[2], uint64_t stream, uint64_t first, size_t count, uint32_t (*out)[4]) noexcept {
+        constexpr size_t W = 8;
+        for (size_t b = 0; b < count; b += W) {
+            uint32_t c0[W], c1[W], c2[W], c3[W];
+            for (size_t l = 0; l < W; l++) {
+                const uint64_t n = first + b + l;
+                c0[l] = static_cast<uint32_t>(n);
+                c1[l] = static_cast<uint32_t>(n >> 32);
+                c2[l] = static_cast<uint32_t>(stream);
+                c3[l] = static_cast<uint32_t>(stream >> 32);
+            }
+            uint32_t k0 = key[0], k1 = key[1];
+            for (size_t round = 0; round < 10; round++) {
+                for (size_t l = 0; l < W; l++) {
+                    const uint64_t p0 = uint64_t{0xd2511f53} * c0[l];
+                    const uint64_t p1 = uint64_t{0xcd9e8d57} * c2[l];
+                    const uint32_t n0 = static_cast<uint32_t>(p1 >> 32) ^ c1[l] ^ k0;
+                    const uint32_t n2 = static_cast<uint32_t>(p0 >> 32) ^ c3[l] ^ k1;
+                    c1[l] = static_cast<uint32_t>(p1);
+                    c3[l] = static_cast<uint32_t>(p0);
+                    c0[l] = n0;
+                    c2[l] = n2;
+                }
+                k0 += 0x9e3779b9;
+                k1 += 0xbb67ae85;
+            }
+            for (size_t l = 0; l < std::min(W, count - b); l++) {
+                out[b + l][0] = c0[l];
+                out[b + l][1] = c1[l];
+                out[b + l][2] = c2[l];
+                out[b + l][3] = c3[l];
+            }
+        }
+    }
+}// namespace detail
+
+
+// counter-based generator: block n of stream s is a pure function of (seed, s, n)
+// so streams never overlap, any position can be reached in O(1), and batch fills come out the same on any number of threads
+class Philox {
+public:
+    using result_type = uint32_t;
+
+
+    explicit Philox(uint64_t seed = 0, uint64_t stream = 0) noexcept
+        : key{static_cast<uint32_t>(seed), static_cast<uint32_t>(seed >> 32)}, id(stream) {}
+
+
+    static constexpr result_type min() noexcept {
+        return 0;
+    }
+
+    static constexpr result_type max() noexcept {
+        return std::numeric_limits<result_type>::max();
+    }
+
+    result_type operator()() noexcept {
+        if (used == 4) {
+            detail::philox_blocks(key, id, counter++, 1, &buffer);
+            used = 0;
+        }
+        return buffer[used++];
+    }
+
+
+    // same seed, another stream, e.g. one per thread
+    [[nodiscard]] Philox stream(uint64_t stream) const noexcept {
+        return Philox(key, stream);
+    }
+
+    [[nodiscard]] uint64_t position() const noexcept {
+        return counter;
+    }
+
+    // skips n blocks of 4 words
+    void discard(uint64_t n) noexcept {
+        counter += n;
+        used = 4;
+    }
+
+    // reserves the next n blocks for the caller and returns the first one, words left over from operator() are dropped
+    uint64_t take(uint64_t n) noexcept {
+        used = 4;
+        return std::exchange(counter, counter + n);
+    }
+
+    // writes blocks first .. first + out.size() - 1 without advancing the generator
+    void blocks(uint64_t first, std::span<uint32_t[4]> out) const noexcept {
+        detail::philox_blocks(key, id, first, out.size(), out.data());
+    }
+
+
+    // fills out with the words of the next out.size() / 4 blocks (rounded up), spread over threads (0 = all hardware threads)
+    void fill(std::span<uint32_t> out, size_t threads = 1) noexcept {
+        const size_t n = (out.size() + 3) / 4;
+        const uint64_t first = take(n);
+        detail::parallel_chunks(n, detail::chunk_count(n, threads, 1 << 14), [&](size_t, size_t begin, size_t end) {
+            uint32_t tmp[64][4];
+            for (size_t b = begin; b < end; b += 64) {
+                const size_t count = std::min<size_t>(64, end - b);
+                blocks(first + b, std::span(tmp, count));
+                std::copy_n(&tmp[0][0], std::min(count * 4, out.size() - b * 4), out.data() + b * 4);
+            }
+        });
+    }
+
+private:
+    Philox(const uint32_t (&key)[2], uint64_t stream) noexcept : key{key[0], key[1]}, id(stream) {}
+
+
+    uint32_t key[2];
+    uint64_t id;
+    uint64_t counter = 0;
+    uint32_t buffer[4]{};
+    size_t used = 4;
+};
+
+
+namespace detail {
+    // float takes 24 bits of one word, double 53 bits of two
+    template <floating T>
+    constexpr size_t words_per_uniform = sizeof(T) / 4;
+
+    template <floating T>
+    [[nodiscard]] constexpr T to_unit(const uint32_t* w) noexcept {
+        if constexpr (std::same_as<T, float>) {
+            return static_cast<float>(w[0] >> 8) * 0x1p-24f;
+        } else {
+            return static_cast<double>(uint64_t{w[0]} << 21 ^ w[1] >> 11) * 0x1p-53;
+        }
+    }
+
+    // sample i is map(u) with u the 4 uniforms in [0, 1) taken from blocks first + i * k .. first + i * k + k - 1
+    template <size_t N, floating T>
+    void sample(Philox& rng, std::span<Vector<N, T>> out, size_t threads, const auto& map) noexcept {
+        constexpr size_t k = words_per_uniform<T>;
+        const uint64_t first = rng.take(out.size() * k);
+        detail::parallel_chunks(out.size(), detail::chunk_count(out.size(), threads, 1 << 14), [&](size_t, size_t begin, size_t end) {
+            constexpr size_t batch = 64;
+            uint32_t words[batch * k][4];
+            for (size_t b = begin; b < end; b += batch) {
+                const size_t count = std::min(batch, end - b);
+                rng.blocks(first + b * k, std::span(words, count * k));
+                for (size_t i = 0; i < count; i++) {
+                    // the k blocks as one flat array, w + k would step past the end of words[i * k] for double
+                    uint32_t w[4 * k];
+                    std::memcpy(w, words[i * k], sizeof(w));
+                    const T u[4]{to_unit<T>(w), to_unit<T>(w + k), to_unit<T>(w + 2 * k), to_unit<T>(w + 3 * k)};
+                    out[b + i] = map(u);
+                }
+            }
+        });
+    }
+}// namespace detail
+
+
+// batch samplers, each consumes whole blocks of rng and is reproducible for any threads (0 = all hardware threads)
+
+// uniform in [0, 1)^N
+template <size_t N, detail::floating T>
+void uniform(Philox& rng, std::span<Vector<N, T>> out, size_t threads = 1) noexcept {
+    detail::sample(rng, out, threads, [](const T (&u)[4]) {
+        return [&]<size_t... Is>(std::index_sequence<Is...>) {
+            return Vector<N, T>{u[Is]...};
+        }(std::make_index_sequence<N>{});
+    });
+}
+
+// uniform in the box [lo, hi)
+template <size_t N, detail::floating T>
+void uniform(Philox& rng, std::span<Vector<N, T>> out, const std::type_identity_t<Vector<N, T>>& lo, const std::type_identity_t<Vector<N, T>>& hi, size_t threads = 1) noexcept {
+    const Vector<N, T> size = hi - lo;
+    detail::sample(rng, out, threads, [&](const T (&u)[4]) {
+        return [&]<size_t... Is>(std::index_sequence<Is...>) {
+            return Vector<N, T>{(lo[Is] + size[Is] * u[Is])...};
+        }(std::make_index_sequence<N>{});
+    });
+}
+
+// uniform in the unit disk
+template <detail::floating T>
+void in_disk(Philox& rng, std::span<Vector<2, T>> out, size_t threads = 1) noexcept {
+    detail::sample(rng, out, threads, [](const T (&u)[4]) {
+        const T r = std::sqrt(u[0]);
+        const T phi = 2 * std::numbers::pi_v<T> * u[1];
+        return Vector<2, T>{r * std::cos(phi), r * std::sin(phi)};
+    });
+}
+
+// uniform on the unit sphere
+template <detail::floating T>
+void on_sphere(Philox& rng, std::span<Vector<3, T>> out, size_t threads = 1) noexcept {
+    detail::sample(rng, out, threads, [](const T (&u)[4]) {
+        const T z = 1 - 2 * u[0];
+        const T r = std::sqrt(std::max(T{0}, 1 - z * z));
+        const T phi = 2 * std::numbers::pi_v<T> * u[1];
+        return Vector<3, T>{r * std::cos(phi), r * std::sin(phi), z};
+    });
+}
+
+// unit directions around +z with density cos(theta) / pi, a disk sample lifted onto the hemisphere
+template <detail::floating T>
+void cosine_hemisphere(Philox& rng, std::span<Vector<3, T>> out, size_t threads = 1) noexcept {
+    detail::sample(rng, out, threads, [](const T (&u)[4]) {
+        const T r = std::sqrt(u[0]);
+        const T phi = 2 * std::numbers::pi_v<T> * u[1];
+        return Vector<3, T>{r * std::cos(phi), r * std::sin(phi), std::sqrt(std::max(T{0}, 1 - u[0]))};
+    });
+}
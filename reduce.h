@@ -0,0 +1,139 @@
+#pragma once
+
+
+#include <cmath>
+#include <cstdint>
+
+#include <span>
+#include <type_traits>
+#include <vector>
+
+#include "Vector.h"
+#include "dispatch.h"
+#include "parallel.h"
+
+
+// reductions whose grouping is fixed by the input size alone: the same input gives the same bits on 1 or 64 threads
+// blocks of reduce_block elements are folded by 4 interleaved chains combined as (0 op 1) op (2 op 3),
+// and the block results by a balanced binary tree
+
+
+// how a multiply feeding an add is rounded
+// none rounds the product first, also where gcc would otherwise fuse it (it contracts across statements by default)
+// fma uses std::fma, rounded once and identical on every target, fast where the hardware has FMA
+enum class contraction : uint8_t {
+    none,
+    fma
+};
+
+
+namespace detail {
+    constexpr size_t reduce_block = 1 << 12;
+
+
+    template <typename R>
+    [[nodiscard]] constexpr R chain_fold(size_t begin, size_t end, const R& identity, const auto& map, const auto& op) {
+        R acc[4]{identity, identity, identity, identity};
+        size_t i = begin;
+        for (; i + 4 <= end; i += 4) {
+            acc[0] = op(acc[0], map(i));
+            acc[1] = op(acc[1], map(i + 1));
+            acc[2] = op(acc[2], map(i + 2));
+            acc[3] = op(acc[3], map(i + 3));
+        }
+        for (; i < end; i++) {
+            acc[0] = op(acc[0], map(i));
+        }
+        return op(op(acc[0], acc[1]), op(acc[2], acc[3]));
+    }
+
+    // neighbours are paired level by level and an odd last value moves up unchanged, in place;
+    // a loop rather than recursion, so dispatch's flatten inlines all of it into the level's code
+    template <typename R>
+    [[nodiscard]] constexpr R tree_fold(R* v, size_t n, const auto& op) {
+        for (; n > 1; n = (n + 1) / 2) {
+            for (size_t i = 0; i < n / 2; i++) {
+                v[i] = op(v[2 * i], v[2 * i + 1]);
+            }
+            if (n % 2) {
+                v[n / 2] = v[n - 1];
+            }
+        }
+        return v[0];
+    }
+
+    // folds map(0) .. map(n - 1) with op, blocks on up to threads threads (0 = all hardware threads)
+    // unfused, so map and op round the same on every instruction set level; fused only when all fusing is explicit
+    template <bool fused = false, typename R>
+    [[nodiscard]] R deterministic_reduce(size_t n, const R& identity, const auto& map, const auto& op, size_t threads) {
+        if (n <= reduce_block) {
+            R result = identity;
+            dispatch<fused>([&] { result = chain_fold(0, n, identity, map, op); });
+            return result;
+        }
+        std::vector<R> partial((n + reduce_block - 1) / reduce_block);
+        parallel_blocks(n, reduce_block, threads, [&](size_t b, size_t begin, size_t end) {
+            dispatch<fused>([&] { partial[b] = chain_fold(begin, end, identity, map, op); });
+        });
+        // the combine applies op as well and is compiled like the blocks
+        R result = identity;
+        dispatch<fused>([&] { result = tree_fold(partial.data(), partial.size(), op); });
+        return result;
+    }
+
+
+    // a * b rounded on its own: clang is stopped by the pragma in the caller, gcc contracts across statements
+    // whenever FMA instructions are enabled, so there the product goes through an empty asm it cannot look into
+    template <floating T>
+    [[nodiscard]] constexpr T rounded_product(T a, T b) noexcept {
+        T p = a * b;
+#if defined(__GNUC__) && !defined(__clang__) && (defined(__FP_FAST_FMA) || defined(__FP_FAST_FMAF))
+        if !consteval {
+    #if defined(__SSE2__)
+            asm("" : "+x"(p));
+    #elif defined(__aarch64__)
+            asm("" : "+w"(p));
+    #else
+            asm("" : "+m"(p));
+    #endif
+        }
+#endif
+        return p;
+    }
+
+    template <contraction C, size_t N, floating T>
+    [[nodiscard]] constexpr T dot_product(const Vector<N, T>& a, const Vector<N, T>& b) noexcept {
+#if defined(__clang__)
+    #pragma clang fp contract(off)
+#endif
+        T d = C == contraction::fma ? a[0] * b[0] : rounded_product(a[0], b[0]);
+        for (size_t i = 1; i < N; i++) {
+            if constexpr (C == contraction::fma) {
+                d = std::fma(a[i], b[i], d);
+            } else {
+                d = d + rounded_product(a[i], b[i]);
+            }
+        }
+        return d;
+    }
+}// namespace detail
+
+
+// op must have identity as its neutral element, e.g. min with +inf or + with 0
+template <size_t N, detail::numeric T, typename Op>
+[[nodiscard]] Vector<N, T> reduce(std::span<const Vector<N, T>> values, const std::type_identity_t<Vector<N, T>>& identity, const Op& op, size_t threads = 1) {
+    return detail::deterministic_reduce(values.size(), identity, [&](size_t i) -> const Vector<N, T>& { return values[i]; }, op, threads);
+}
+
+// op folds the results of map(values[i]), which may have any type R
+template <size_t N, detail::numeric T, typename R, typename Map, typename Op>
+[[nodiscard]] R transform_reduce(std::span<const Vector<N, T>> values, const R& identity, const Map& map, const Op& op, size_t threads = 1) {
+    return detail::deterministic_reduce(values.size(), identity, [&](size_t i) { return map(values[i]); }, op, threads);
+}
+
+// sum of dot(a[i], b[i])
+template <contraction C = contraction::none, size_t N, detail::floating T>
+[[nodiscard]] T dot(std::span<const Vector<N, T>> a, std::type_identity_t<std::span<const Vector<N, T>>> b, size_t threads = 1) {
+    // std::fma needs the FMA instructions of the fused levels to be fast
+    return detail::deterministic_reduce<C == contraction::fma>(a.size(), T{0}, [&](size_t i) { return detail::dot_product<C>(a[i], b[i]); }, [](T l, T r) { return l + r; }, threads);
+}
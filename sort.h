@@ -0,0 +1,171 @@
+#pragma once
+
+
+#include <cstdint>
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "Vector.h"
+#include "parallel.h"
+#include "radix_sort.h"
+
+
+namespace detail {
+    template <size_t S>
+    using unsigned_of_size = std::conditional_t<S == 1, uint8_t, std::conditional_t<S == 2, uint16_t, std::conditional_t<S == 4, uint32_t, uint64_t>>>;
+
+    // unsigned key with the same order as x: the sign bit of signed integers is flipped,
+    // negative floats are inverted and positive ones get the sign bit, so -0 sorts before +0 and NaNs at the ends
+    template <typename T>
+        requires(integral<T> || floating<T>)
+    [[nodiscard]] constexpr auto ordered_bits(T x) noexcept {
+        using U = unsigned_of_size<sizeof(T)>;
+        constexpr U sign = U{1} << (sizeof(T) * 8 - 1);
+        const U bits = std::bit_cast<U>(x);
+        if constexpr (floating<T>) {
+            return static_cast<U>(bits & sign ? ~bits : bits | sign);
+        } else if constexpr (signed_integral<T>) {
+            return static_cast<U>(bits ^ sign);
+        } else {
+            return bits;
+        }
+    }
+
+    // all lanes in one key, lane 0 in the most significant bits
+    template <size_t N, typename T>
+    constexpr bool packed_key = N * sizeof(T) <= 8;
+
+    template <size_t N, typename T>
+    [[nodiscard]] constexpr auto lexicographic_key(const Vector<N, T>& v) noexcept
+        requires packed_key<N, T> {
+        using K = std::conditional_t<N * sizeof(T) <= 4, uint32_t, uint64_t>;
+        return [&]<size_t... Is>(std::index_sequence<Is...>) {
+            return static_cast<K>((... | (static_cast<K>(ordered_bits(v[Is])) << (N - 1 - Is) * sizeof(T) * 8)));
+        }(std::make_index_sequence<N>{});
+    }
+
+    template <typename F, size_t N, typename T>
+    using projected_key = decltype(ordered_bits(std::declval<const F&>()(std::declval<const Vector<N, T>&>())));
+}// namespace detail
+
+
+// strict weak order over Vectors, lane 0 first; for std::lower_bound, std::equal_range, std::set etc.
+struct lexicographic_less {
+    template <size_t N, typename T>
+    [[nodiscard]] constexpr bool operator()(const Vector<N, T>& lhs, const Vector<N, T>& rhs) const noexcept {
+        for (size_t i = 0; i < N; i++) {
+            if (lhs[i] < rhs[i]) {
+                return true;
+            }
+            if (rhs[i] < lhs[i]) {
+                return false;
+            }
+        }
+        return false;
+    }
+};
+
+
+// orders points lane 0 first with radix sorts on up to threads threads (0 = all hardware threads)
+// lanes fitting in 64 bits together are sorted with a single key, wider Vectors lane by lane from the last lane,
+// the passes are stable so earlier lanes decide
+template <size_t N, typename T>
+    requires(detail::integral<T> || detail::floating<T>)
+void sort_lexicographic(std::span<Vector<N, T>> points, size_t threads = 1) {
+    const size_t chunks = detail::chunk_count(points.size(), threads, 1 << 14);
+    if constexpr (detail::packed_key<N, T>) {
+        std::vector<decltype(detail::lexicographic_key(points[0]))> keys(points.size());
+        detail::parallel_chunks(points.size(), chunks, [&](size_t, size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) {
+                keys[i] = detail::lexicographic_key(points[i]);
+            }
+        });
+        radix_sort_by_key(std::span(keys), points, threads);
+    } else {
+        std::vector<detail::unsigned_of_size<sizeof(T)>> keys(points.size());
+        for (size_t lane = N; lane-- > 0;) {
+            detail::parallel_chunks(points.size(), chunks, [&](size_t, size_t begin, size_t end) {
+                for (size_t i = begin; i < end; i++) {
+                    keys[i] = detail::ordered_bits(points[i][lane]);
+                }
+            });
+            radix_sort_by_key(std::span(keys), points, threads);
+        }
+    }
+}
+
+// stable sort by an arithmetic key, e.g. [](const auto& v) { return v.y; } or [](const auto& v) { return dot(v, v); }
+template <size_t N, typename T, typename F>
+void sort_by(std::span<Vector<N, T>> points, const F& key, size_t threads = 1) {
+    std::vector<detail::projected_key<F, N, T>> keys(points.size());
+    detail::parallel_chunks(points.size(), detail::chunk_count(points.size(), threads, 1 << 14), [&](size_t, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            keys[i] = detail::ordered_bits(key(points[i]));
+        }
+    });
+    radix_sort_by_key(std::span(keys), points, threads);
+}
+
+// moves the points satisfying pred to the front, keeping the order on both sides; returns how many there are
+// every chunk counts its matches first, so the points can be scattered to their final place in parallel
+template <size_t N, typename T, typename F>
+size_t partition_by(std::span<Vector<N, T>> points, const F& pred, size_t threads = 1) {
+    const size_t n = points.size();
+    const size_t chunks = detail::chunk_count(n, threads, 1 << 14);
+    std::vector<std::array<size_t, 2>> offsets(chunks);
+    std::vector<uint8_t> flags(n);
+    detail::parallel_chunks(n, chunks, [&](size_t c, size_t begin, size_t end) {
+        size_t count = 0;
+        for (size_t i = begin; i < end; i++) {
+            flags[i] = static_cast<bool>(pred(points[i]));
+            count += flags[i];
+        }
+        offsets[c] = {count, end - begin - count};
+    });
+
+    size_t matches = 0;
+    for (const auto& o : offsets) {
+        matches += o[0];
+    }
+    size_t front = 0, back = matches;
+    for (auto& o : offsets) {
+        front += std::exchange(o[0], front);
+        back += std::exchange(o[1], back);
+    }
+
+    std::vector<Vector<N, T>> buffer(n);
+    detail::parallel_chunks(n, chunks, [&](size_t c, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            buffer[offsets[c][flags[i] ? 0 : 1]++] = points[i];
+        }
+    });
+    std::copy(buffer.begin(), buffer.end(), points.begin());
+    return matches;
+}
+
+// removes consecutive points equal in every lane, returns the new size; sort first to remove all duplicates
+template <size_t N, typename T>
+size_t unique_points(std::span<Vector<N, T>> points) noexcept {
+    return std::unique(points.begin(), points.end(), [](const Vector<N, T>& lhs, const Vector<N, T>& rhs) { return (lhs == rhs).all(); }) - points.begin();
+}
+
+// puts the point with the nth smallest key at points[nth], smaller keys before and larger ones after it
+// keys are computed once and selected together with their points
+template <size_t N, typename T, typename F>
+void nth_element_by(std::span<Vector<N, T>> points, size_t nth, const F& key) {
+    using K = detail::projected_key<F, N, T>;
+    std::vector<std::pair<K, Vector<N, T>>> keyed(points.size());
+    for (size_t i = 0; i < points.size(); i++) {
+        keyed[i] = {detail::ordered_bits(key(points[i])), points[i]};
+    }
+    std::nth_element(keyed.begin(), keyed.begin() + nth, keyed.end(), [](const auto& lhs, const auto& rhs) { return lhs.first < rhs.first; });
+    for (size_t i = 0; i < points.size(); i++) {
+        points[i] = keyed[i].second;
+    }
+}
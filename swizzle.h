@@ -0,0 +1,152 @@
+#pragma once
+
+
+#include <cstdint>
+#include <cstring>
+
+#include <algorithm>
+#include <array>
+#include <optional>
+#include <span>
+#include <string_view>
+
+#include "Vector.h"
+#include "dispatch.h"
+
+#if defined(VECTOR_DISPATCH_X86)
+    #include <immintrin.h>
+#endif
+
+
+namespace detail {
+    // the letter sets of the Vector<N, T> members, the lane of a letter is its position in the set
+    [[nodiscard]] constexpr std::array<std::string_view, 3> swizzle_sets(size_t n) noexcept {
+        switch (n) {
+            case 2:
+                return {"xy", "uv", ""};
+            case 3:
+                return {"xyz", "uvw", "rgb"};
+            default:
+                return {"xyzw", "rgba", ""};
+        }
+    }
+
+#if defined(VECTOR_DISPATCH_X86)
+    // one pshufb per Vector, the lanes are copied through a register-sized buffer because Vectors are not contiguous
+    template <size_t N, size_t M, numeric T>
+    [[gnu::target("avx2")]] void shuffle_vectors_avx2(std::span<const Vector<N, T>> in, std::span<Vector<M, T>> out, const uint8_t (&ctrl)[16]) noexcept {
+        const __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ctrl));
+        for (size_t i = 0; i < in.size(); i++) {
+            alignas(16) unsigned char buffer[16];
+            std::memcpy(buffer, &in[i][0], N * sizeof(T));
+            _mm_store_si128(reinterpret_cast<__m128i*>(buffer), _mm_shuffle_epi8(_mm_load_si128(reinterpret_cast<const __m128i*>(buffer)), c));
+            std::memcpy(&out[i][0], buffer, M * sizeof(T));
+        }
+    }
+
+    // 8 pixels per vpshufb, the 16-byte control repeated in both halves
+    [[gnu::target("avx2")]] inline size_t shuffle_pixels_avx2(const uint32_t* in, uint32_t* out, size_t n, const uint8_t (&ctrl)[16]) noexcept {
+        const __m256i c = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(ctrl)));
+        size_t i = 0;
+        for (; i + 8 <= n; i += 8) {
+            const __m256i p = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_shuffle_epi8(p, c));
+        }
+        return i;
+    }
+#endif
+}// namespace detail
+
+
+// swizzle chosen at run time, e.g. from a configuration string, mapping Vector<N, T> to Vector<M, T>
+// parse() compiles the pattern once into lane indices and a byte shuffle control that is then reused for whole spans
+template <size_t N, size_t M = N>
+    requires(N >= 2 && N <= 4 && M >= 2 && M <= 4)
+class RuntimeSwizzle {
+public:
+    // M letters from one letter set of the Vector<N, T> members: xy or uv, xyz, uvw or rgb, xyzw or rgba;
+    // mixed sets such as "xgb" are rejected like at compile time, nullopt then
+    [[nodiscard]] static constexpr std::optional<RuntimeSwizzle> parse(std::string_view pattern) noexcept {
+        if (pattern.size() != M) {
+            return std::nullopt;
+        }
+        const auto sets = detail::swizzle_sets(N);
+        const auto set = std::find_if(sets.begin(), sets.end(), [&](std::string_view letters) {
+            return !letters.empty() && pattern.find_first_not_of(letters) == std::string_view::npos;
+        });
+        if (set == sets.end()) {
+            return std::nullopt;
+        }
+        RuntimeSwizzle s;
+        for (size_t i = 0; i < M; i++) {
+            s.index[i] = static_cast<uint8_t>(set->find(pattern[i]));
+        }
+        // packed 8-bit channels, 4 pixels of N bytes in and M bytes out per 16 bytes
+        if constexpr (N == 4 && M == 4) {
+            for (size_t p = 0; p < 4; p++) {
+                for (size_t i = 0; i < 4; i++) {
+                    s.pixel_ctrl[p * 4 + i] = static_cast<uint8_t>(p * 4 + s.index[i]);
+                }
+            }
+        }
+        return s;
+    }
+
+
+    [[nodiscard]] constexpr size_t operator[](size_t i) const noexcept {
+        return index[i];
+    }
+
+
+    template <detail::numeric T>
+    [[nodiscard]] constexpr Vector<M, T> operator()(const Vector<N, T>& v) const noexcept {
+        return [&]<size_t... Is>(std::index_sequence<Is...>) {
+            return Vector<M, T>{v[index[Is]]...};
+        }(std::make_index_sequence<M>{});
+    }
+
+    // out[i] = swizzle of in[i], out may be in when N == M
+    template <detail::numeric T>
+    void operator()(std::span<const Vector<N, T>> in, std::span<Vector<M, T>> out) const noexcept {
+#if defined(VECTOR_DISPATCH_X86)
+        if constexpr (N * sizeof(T) <= 16 && M * sizeof(T) <= 16) {
+            if (active_isa() >= isa::avx2) {
+                uint8_t ctrl[16];
+                std::fill_n(ctrl, 16, uint8_t{0x80});
+                for (size_t i = 0; i < M; i++) {
+                    for (size_t k = 0; k < sizeof(T); k++) {
+                        ctrl[i * sizeof(T) + k] = static_cast<uint8_t>(index[i] * sizeof(T) + k);
+                    }
+                }
+                detail::shuffle_vectors_avx2<N, M, T>(in, out, ctrl);
+                return;
+            }
+        }
+#endif
+        for (size_t i = 0; i < in.size(); i++) {
+            out[i] = (*this)(in[i]);
+        }
+    }
+
+    // channel remapping of packed 8-bit pixels, e.g. parse("bgra") turns BGRA8 into RGBA8; out may be in
+    void operator()(std::span<const uint32_t> in, std::span<uint32_t> out) const noexcept
+        requires(N == 4 && M == 4) {
+        size_t i = 0;
+#if defined(VECTOR_DISPATCH_X86)
+        if (active_isa() >= isa::avx2) {
+            i = detail::shuffle_pixels_avx2(in.data(), out.data(), in.size(), pixel_ctrl);
+        }
+#endif
+        for (; i < in.size(); i++) {
+            const uint32_t p = in[i];
+            out[i] = (p >> index[0] * 8 & 0xff) | (p >> index[1] * 8 & 0xff) << 8 | (p >> index[2] * 8 & 0xff) << 16 | (p >> index[3] * 8 & 0xff) << 24;
+        }
+    }
+
+private:
+    constexpr RuntimeSwizzle() noexcept = default;
+
+
+    uint8_t index[M]{};
+    uint8_t pixel_ctrl[16]{};
+};
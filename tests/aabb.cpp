@@ -0,0 +1,41 @@
+#include <cstdlib>
+
+#include <iostream>
+#include <limits>
+#include <optional>
+
+#include "AABB.h"
+
+
+namespace {
+    int failures = 0;
+
+    std::ostream& operator<<(std::ostream& os, std::optional<float> t) {
+        return t ? os << "hit at " << *t : os << "miss";
+    }
+
+    void check(const char* what, std::optional<float> got, std::optional<float> expected) {
+        if (got != expected) {
+            std::cerr << what << ": expected " << expected << ", got " << got << "\n";
+            failures++;
+        }
+    }
+}// namespace
+
+
+// axis-parallel rays against the unit box, inv_dir has infinite lanes for the zero direction components
+int main() {
+    const AABB<3, float> box(Vector<3, float>(0.f), Vector<3, float>(1.f));
+    const Vector<3, float> inv_dir = 1.f / Vector<3, float>(1.f, 0.f, 0.f);
+
+    check("through the middle", box.intersect(Vector<3, float>(-1.f, 0.5f, 0.5f), inv_dir), 1.f);
+    check("beside the box", box.intersect(Vector<3, float>(-1.f, 2.f, 0.5f), inv_dir), std::nullopt);
+    // lying in the y = lo and y = hi boundary planes: 0 * inf on the respective slab
+    check("in the lower boundary plane", box.intersect(Vector<3, float>(-1.f, 0.f, 0.5f), inv_dir), std::nullopt);
+    check("in the upper boundary plane", box.intersect(Vector<3, float>(-1.f, 1.f, 0.5f), inv_dir), std::nullopt);
+    check("along a boundary edge", box.intersect(Vector<3, float>(-1.f, 0.f, 1.f), inv_dir), std::nullopt);
+    check("in a plane, bounded t_max", box.intersect(Vector<3, float>(-1.f, 0.f, 0.5f), inv_dir, 0.f, 10.f), std::nullopt);
+    // every slab gives 0 * inf and inf, previously an entry at infinity
+    check("zero direction on a corner", box.intersect(Vector<3, float>(0.f), 1.f / Vector<3, float>(0.f)), std::nullopt);
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
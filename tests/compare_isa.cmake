@@ -0,0 +1,18 @@
+# cmake -DEXE=<program>[;<program>...] -P compare_isa.cmake: runs every program under every VECTOR_ISA level,
+# the outputs must be identical, e.g. of a default build and an -mfma build of the same source
+set(reference "")
+foreach(exe ${EXE})
+    foreach(level sse2 avx2 avx512)
+        execute_process(COMMAND ${CMAKE_COMMAND} -E env VECTOR_ISA=${level} ${exe} OUTPUT_VARIABLE out RESULT_VARIABLE rc)
+        if(NOT rc EQUAL 0)
+            message(FATAL_ERROR "${exe} failed with VECTOR_ISA=${level}: ${rc}")
+        endif()
+        if(reference STREQUAL "")
+            set(reference "${out}")
+            set(reference_run "${exe} with VECTOR_ISA=${level}")
+        elseif(NOT out STREQUAL reference)
+            message(FATAL_ERROR "${exe} with VECTOR_ISA=${level}:\n${out}differs from ${reference_run}:\n${reference}")
+        endif()
+    endforeach()
+endforeach()
+message("${reference}")
@@ -0,0 +1,20 @@
+#include <cstdint>
+#include <cstdlib>
+
+#include <iostream>
+
+#include "differential.h"
+
+
+// differential [seeds] [programs]: every dimension and element type, programs operator chains each per seed
+int main(int argc, char** argv) {
+    const uint64_t seeds = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 8;
+    const size_t programs = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 16;
+
+    DiffReport report;
+    for (uint64_t s = 0; s < seeds; s++) {
+        report.merge(differential_check_all({}, s << 8, programs));
+    }
+    std::cout << isa_name(active_isa()) << ": " << report;
+    return report.mismatches ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,18 @@
+#include <cstdint>
+#include <cstdlib>
+
+#include <iostream>
+#include <span>
+
+#include "differential.h"
+
+
+// the input bytes choose the operator chain and the values, one chain per dimension and element type
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    const DiffReport report = differential_check_all(std::span(data, size), 0, 1, 16);
+    if (report.mismatches) {
+        std::cerr << report;
+        std::abort();
+    }
+    return 0;
+}
@@ -0,0 +1,60 @@
+#include <cstdlib>
+
+#include <iostream>
+#include <limits>
+
+#include "interval.h"
+
+
+namespace {
+    int failures = 0;
+
+    template <typename T>
+    void check_contains(const char* what, Interval<T> i, T lo, T hi) {
+        if (!(i.lo <= lo && hi <= i.hi)) {
+            std::cerr << what << ": " << i << " does not contain [" << lo << ", " << hi << "]\n";
+            failures++;
+        }
+    }
+
+    // unbounded and zero endpoints through operator*, double takes the SSE2 path and float the scalar one
+    template <typename T>
+    void unbounded_products() {
+        constexpr T inf = std::numeric_limits<T>::infinity();
+        check_contains<T>("[1, inf] * [0, 1]", Interval<T>{1, inf} * Interval<T>{0, 1}, 0, inf);
+        check_contains<T>("[0, 1] * [1, inf]", Interval<T>{0, 1} * Interval<T>{1, inf}, 0, inf);
+        check_contains<T>("[-inf, -1] * [0, 2]", Interval<T>{-inf, -1} * Interval<T>{0, 2}, -inf, 0);
+        check_contains<T>("[-inf, inf] * [0, 0]", Interval<T>{-inf, inf} * Interval<T>{0, 0}, 0, 0);
+        check_contains<T>("[0, inf] * [-inf, 0]", Interval<T>{0, inf} * Interval<T>{-inf, 0}, -inf, 0);
+        check_contains<T>("[-1, inf] * [-2, 3]", Interval<T>{-1, inf} * Interval<T>{-2, 3}, -inf, inf);
+    }
+
+    // infinite and zero-straddling divisors, inf / inf corners included
+    template <typename T>
+    void unbounded_quotients() {
+        constexpr T inf = std::numeric_limits<T>::infinity();
+        check_contains<T>("[-inf, 5] / [-inf, -1]", Interval<T>{-inf, 5} / Interval<T>{-inf, -1}, -5, inf);
+        check_contains<T>("[1, inf] / [1, inf]", Interval<T>{1, inf} / Interval<T>{1, inf}, 0, inf);
+        check_contains<T>("[-inf, inf] / [2, inf]", Interval<T>{-inf, inf} / Interval<T>{2, inf}, -inf, inf);
+        check_contains<T>("[-inf, -1] / [1, inf]", Interval<T>{-inf, -1} / Interval<T>{1, inf}, -inf, 0);
+        check_contains<T>("[2, 4] / [-inf, -2]", Interval<T>{2, 4} / Interval<T>{-inf, -2}, -2, 0);
+        check_contains<T>("[1, 2] / [-1, 1]", Interval<T>{1, 2} / Interval<T>{-1, 1}, -inf, inf);
+        check_contains<T>("[1, 2] / [0, 1]", Interval<T>{1, 2} / Interval<T>{0, 1}, 1, inf);
+        check_contains<T>("[-inf, inf] / [-inf, 0]", Interval<T>{-inf, inf} / Interval<T>{-inf, 0}, -inf, inf);
+    }
+
+    constexpr Interval<double> constant_quotient = Interval<double>{-std::numeric_limits<double>::infinity(), 5} / Interval<double>{-std::numeric_limits<double>::infinity(), -1};
+    static_assert(constant_quotient.lo <= -5 && constant_quotient.hi == std::numeric_limits<double>::infinity());
+
+    constexpr Interval<double> constant_product = Interval<double>{1, std::numeric_limits<double>::infinity()} * Interval<double>{0, 1};
+    static_assert(constant_product.lo <= 0 && constant_product.hi == std::numeric_limits<double>::infinity());
+}// namespace
+
+
+int main() {
+    unbounded_products<float>();
+    unbounded_products<double>();
+    unbounded_quotients<float>();
+    unbounded_quotients<double>();
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,131 @@
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+
+#include <iostream>
+#include <span>
+#include <vector>
+
+#include "packet.h"
+
+
+namespace {
+    int failures = 0;
+
+    void check(const char* what, bool ok) {
+        if (!ok) {
+            std::cerr << what << " failed\n";
+            failures++;
+        }
+    }
+
+    // every lane of got equals f applied to the matching lanes of the operands
+    template <typename L, typename F, typename... Ls>
+    bool lanes_match(const L& got, const F& f, const Ls&... ls) {
+        for (size_t k = 0; k < L::width; k++) {
+            if (got.lane[k] != f(ls.lane[k]...)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // NaN lanes match NaN
+    template <typename L, typename F, typename... Ls>
+    bool lanes_match_fp(const L& got, const F& f, const Ls&... ls) {
+        for (size_t k = 0; k < L::width; k++) {
+            const auto e = f(ls.lane[k]...);
+            if (got.lane[k] != e && !(std::isnan(got.lane[k]) && std::isnan(e))) {
+                return false;
+            }
+        }
+        return true;
+    }
+}// namespace
+
+
+int main() {
+    constexpr size_t K = 8;
+
+    // integral operators
+    Lanes<int32_t, K> a, b;
+    for (size_t k = 0; k < K; k++) {
+        a.lane[k] = static_cast<int32_t>(k * 37 + 5) * (k % 2 ? -1 : 1);
+        b.lane[k] = static_cast<int32_t>(k % 5 + 1);
+    }
+    check("%", lanes_match(a % b, [](int32_t x, int32_t y) { return x % y; }, a, b));
+    check("&", lanes_match(a & b, [](int32_t x, int32_t y) { return x & y; }, a, b));
+    check("|", lanes_match(a | b, [](int32_t x, int32_t y) { return x | y; }, a, b));
+    check("^", lanes_match(a ^ b, [](int32_t x, int32_t y) { return x ^ y; }, a, b));
+    check("<<", lanes_match(a << b, [](int32_t x, int32_t y) { return x << y; }, a, b));
+    check(">>", lanes_match(a >> 2, [](int32_t x) { return x >> 2; }, a));
+    check("~", lanes_match(~a, [](int32_t x) { return ~x; }, a));
+    Lanes<int32_t, K> c = a;
+    c ^= b;
+    c <<= 1;
+    ++c;
+    check("compound assignment", lanes_match(c, [](int32_t x, int32_t y) { return ((x ^ y) << 1) + 1; }, a, b));
+
+    // comparisons are masks, one bool per lane
+    Lanes<float, K> x, y;
+    for (size_t k = 0; k < K; k++) {
+        x.lane[k] = static_cast<float>(k) - 3.5f;
+        y.lane[k] = static_cast<float>(K - k) * 0.5f;
+    }
+    y.lane[2] = x.lane[2];
+    check("<", lanes_match(x < y, [](float l, float r) { return l < r; }, x, y));
+    check(">=", lanes_match(x >= y, [](float l, float r) { return l >= r; }, x, y));
+    check("==", lanes_match(x == y, [](float l, float r) { return l == r; }, x, y));
+    check("!=", lanes_match(x != 0.5f, [](float l) { return l != 0.5f; }, x));
+    check("&&", lanes_match(x < 0.f && y > 1.f, [](float l, float r) { return l < 0.f && r > 1.f; }, x, y));
+    check("!", lanes_match(!(x < y), [](float l, float r) { return !(l < r); }, x, y));
+    check("any_lane", any_lane(x == y) && !any_lane(x > 100.f));
+    check("all_lanes", all_lanes(x < 100.f) && !all_lanes(x < y));
+    check("select", lanes_match(select(x < y, x, y), [](float l, float r) { return l < r ? l : r; }, x, y));
+
+    // the math functions Vector's members find through ADL
+    const auto u = x.map([](float e) { return e / 4.f; });
+    check("tan", lanes_match_fp(tan(u), [](float e) { return std::tan(e); }, u));
+    check("asin", lanes_match_fp(asin(u), [](float e) { return std::asin(e); }, u));
+    check("acos", lanes_match_fp(acos(u), [](float e) { return std::acos(e); }, u));
+    check("atan", lanes_match_fp(atan(u), [](float e) { return std::atan(e); }, u));
+    check("exp2", lanes_match_fp(exp2(u), [](float e) { return std::exp2(e); }, u));
+    check("log2", lanes_match_fp(log2(u), [](float e) { return std::log2(e); }, u));
+    check("log10", lanes_match_fp(log10(u), [](float e) { return std::log10(e); }, u));
+    check("tanh", lanes_match_fp(tanh(u), [](float e) { return std::tanh(e); }, u));
+    check("erf", lanes_match_fp(erf(u), [](float e) { return std::erf(e); }, u));
+    check("pow", lanes_match_fp(pow(y, u), [](float l, float r) { return std::pow(l, r); }, y, u));
+    check("hypot", lanes_match(hypot(x, y), [](float l, float r) { return std::hypot(l, r); }, x, y));
+    check("atan2", lanes_match(atan2(x, y), [](float l, float r) { return std::atan2(l, r); }, x, y));
+
+    // through Vector: members, component-wise masks and lane-wise reductions
+    Packet<3, float, K> p, q;
+    for (size_t i = 0; i < 3; i++) {
+        p[i] = x;
+        q[i] = y;
+    }
+    q[1] = x - 1.f;
+    check("Packet::tan", lanes_match_fp(p.tan()[0], [](float e) { return std::tan(e); }, x));
+    check("Packet::exp2", lanes_match_fp(p.exp2()[2], [](float e) { return std::exp2(e); }, x));
+    const auto less = p < q;
+    check("Packet <", lanes_match(less[0], [](float l, float r) { return l < r; }, x, y) && !any_lane(less[1]));
+    check("Packet any", lanes_match(less.any(), [](float l, float r) { return l < r; }, x, y));
+    check("Packet all", !any_lane(less.all()));
+
+    // a kernel changing the element type
+    std::vector<Vector<3, float>> in;
+    for (size_t i = 0; i < 21; i++) {
+        in.push_back(Vector<3, float>(static_cast<float>(i) / 3.f, 1.f, -static_cast<float>(i)));
+    }
+    std::vector<Vector<3, double>> out(in.size());
+    packet_map<K>(std::span<const Vector<3, float>>(in), std::span(out), [](const auto& v) { return v.template cast<double>() * 2.; });
+    bool cast_ok = true;
+    for (size_t i = 0; i < in.size(); i++) {
+        for (size_t j = 0; j < 3; j++) {
+            cast_ok &= out[i][j] == static_cast<double>(in[i][j]) * 2.;
+        }
+    }
+    check("packet_map cast<double>", cast_ok);
+
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
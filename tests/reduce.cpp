@@ -0,0 +1,30 @@
+#include <cstdint>
+#include <cstdlib>
+
+#include <bit>
+#include <iostream>
+#include <vector>
+
+#include "random.h"
+#include "reduce.h"
+
+
+// prints the bits of the deterministic reductions, compare_isa.cmake runs it under every VECTOR_ISA level
+int main() {
+    Philox rng(7);
+    std::vector<Vector<3, float>> a(50'000), b(50'000);
+    uniform(rng, std::span(a), Vector<3, float>(-1.f), Vector<3, float>(1.f));
+    uniform(rng, std::span(b), Vector<3, float>(-1.f), Vector<3, float>(1.f));
+    const std::span<const Vector<3, float>> sa(a), sb(b);
+
+    const auto bits = [](float x) { return std::bit_cast<uint32_t>(x); };
+    std::cout << std::hex;
+    std::cout << "dot " << bits(dot(sa, sb, 4)) << "\n";
+    std::cout << "dot fma " << bits(dot<contraction::fma>(sa, sb, 4)) << "\n";
+    // a multiply feeding an add in user code, the pattern the compiler would fuse
+    std::cout << "transform_reduce " << bits(transform_reduce(sa, 0.f, [](const Vector<3, float>& v) { return v.x * v.y + v.z; }, [](float l, float r) { return l + r; }, 4)) << "\n";
+    // 0.3f makes the product inexact, so a fused combine would round differently
+    const Vector<3, float> r = reduce(sa, Vector<3, float>(0.f), [](const auto& l, const auto& r) { return l * 0.3f + r; }, 4);
+    std::cout << "reduce " << bits(r.x) << " " << bits(r.y) << " " << bits(r.z) << "\n";
+    return EXIT_SUCCESS;
+}
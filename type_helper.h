@@ -3,9 +3,27 @@
 
 #include <cstdint>
 
+#include <algorithm>
 #include <concepts>
 
 
+// how binary operators combine two different integral or floating element types, e.g. Vector<3, int> + 1.
+// the policy of a translation unit is VECTOR_PROMOTION (widen by default) and can be overridden for a pair of
+// element types by specializing detail::promotion_v; it must agree between translation units linked together
+// defining VECTOR_WARN_WIDENING reports every promotion to a wider type as a deprecation warning at its use
+enum class promotion : uint8_t {
+    widen, // the wider type, Vector<3, int> + 1. is Vector<3, double>
+    strict,// mixed element types do not compile, scalars have to be written in the element type
+    left,  // the left operand's type, Vector<3, int> + 1. is Vector<3, int>
+    glsl   // scalars are converted to the Vector's element type first like typed GLSL literals, Vector<3, float> * 2. stays float
+};
+
+
+#if !defined(VECTOR_PROMOTION)
+#define VECTOR_PROMOTION widen
+#endif
+
+
 namespace detail {
     template <typename T, typename... Ts>
     constexpr bool is_any_of_v = (std::is_same_v<T, Ts> || ...);
@@ -22,8 +40,77 @@ namespace detail {
     template <typename T>
     concept floating = is_any_of_v<std::remove_cv_t<T>, float, double>;
 
+    // specialized to true by fixed-point element types, see fixed.h
+    template <typename T>
+    constexpr bool is_fixed_point_v = false;
+
+    template <typename T>
+    concept fixed_point = is_fixed_point_v<std::remove_cv_t<T>>;
+
+    // specialized to true by interval element types, see interval.h
+    template <typename T>
+    constexpr bool is_interval_v = false;
+
+    template <typename T>
+    concept interval = is_interval_v<std::remove_cv_t<T>>;
+
+    // specialized to true by dual number element types, see dual.h
+    template <typename T>
+    constexpr bool is_dual_v = false;
+
+    template <typename T>
+    concept dual = is_dual_v<std::remove_cv_t<T>>;
+
+    // specialized to true by SIMD lane group element types, see packet.h
+    template <typename T>
+    constexpr bool is_lanes_v = false;
+
+    template <typename T>
+    concept lanes = is_lanes_v<std::remove_cv_t<T>>;
+
+    // integral types and lane groups of them, the element types of the bitwise operators
+    template <typename T>
+    concept integral_or_lanes = integral<T> || lanes<T> && integral<typename T::value_type>;
+
     template <typename T>
-    concept numeric = integral<T> || floating<T>;
+    concept numeric = integral<T> || floating<T> || fixed_point<T> || interval<T> || dual<T> || lanes<T>;
+
+
+    // the element type cast<T> converts E to, specialized by lane groups to convert every lane, see packet.h
+    template <typename E, typename T>
+    struct cast_type {
+        using type = T;
+    };
+
+    template <typename E, typename T>
+    using cast_type_t = typename cast_type<E, T>::type;
+
+
+    // policy for L op R, see promotion
+    template <typename L, typename R>
+    constexpr promotion promotion_v = promotion::VECTOR_PROMOTION;
+
+#if defined(VECTOR_WARN_WIDENING)
+    template <typename L, typename R, typename C>
+    [[deprecated("mixed element types are promoted to a wider type, see VECTOR_PROMOTION")]] constexpr void widening() noexcept {}
+#endif
+
+    template <typename L, typename R>
+    constexpr auto arithmetic_common_type() noexcept {
+        if constexpr (floating<L> || floating<R>) {
+            return std::common_type_t<L, R>{};
+        } else {
+            using LL = std::conditional_t<std::is_same_v<L, bool>, uint8_t, L>;
+            using RR = std::conditional_t<std::is_same_v<R, bool>, uint8_t, R>;
+            if constexpr (std::is_signed_v<LL> == std::is_signed_v<RR>) {
+                return std::conditional_t<(sizeof(LL) > sizeof(R)), LL, RR>{};
+            } else {
+                using S = std::conditional_t<std::is_signed_v<LL>, LL, RR>;
+                using U = std::conditional_t<std::is_signed_v<LL>, RR, LL>;
+                return std::conditional_t<(sizeof(U) >= sizeof(S)), U, S>{};
+            }
+        }
+    }
 
 
     template <numeric L, numeric R>
@@ -31,17 +118,60 @@ namespace detail {
         if constexpr (std::is_same_v<L, R>) {
             return L{};
         } else {
-            if constexpr (floating<L> || floating<R>) {
-                return std::common_type_t<L, R>{};
+            if constexpr (lanes<L> || lanes<R>) {
+                // scalars are broadcast into the lane group, of two lane groups the wider one
+                if constexpr (!lanes<R>) {
+                    return L{};
+                } else if constexpr (!lanes<L>) {
+                    return R{};
+                } else {
+                    return std::conditional_t<(sizeof(L) >= sizeof(R)), L, R>{};
+                }
+            } else if constexpr (interval<L> || interval<R>) {
+                // scalars convert into the interval type with outward rounding, of two interval types the wider one
+                if constexpr (!interval<R>) {
+                    return L{};
+                } else if constexpr (!interval<L>) {
+                    return R{};
+                } else {
+                    return std::conditional_t<(sizeof(L) >= sizeof(R)), L, R>{};
+                }
+            } else if constexpr (dual<L> || dual<R>) {
+                // scalars become constants of the dual type, of two dual types the wider one
+                if constexpr (!dual<R>) {
+                    return L{};
+                } else if constexpr (!dual<L>) {
+                    return R{};
+                } else {
+                    return std::conditional_t<(sizeof(L) >= sizeof(R)), L, R>{};
+                }
+            } else if constexpr (fixed_point<L> || fixed_point<R>) {
+                // floating types win, integers convert into the fixed type, of two fixed types the wider one (more fraction bits on a tie)
+                if constexpr (floating<L>) {
+                    return L{};
+                } else if constexpr (floating<R>) {
+                    return R{};
+                } else if constexpr (!fixed_point<R>) {
+                    return L{};
+                } else if constexpr (!fixed_point<L>) {
+                    return R{};
+                } else {
+                    constexpr bool left = sizeof(L) != sizeof(R) ? sizeof(L) > sizeof(R) : L::fraction_bits > R::fraction_bits;
+                    return std::conditional_t<left, L, R>{};
+                }
             } else {
-                using LL = std::conditional_t<std::is_same_v<L, bool>, uint8_t, L>;
-                using RR = std::conditional_t<std::is_same_v<R, bool>, uint8_t, R>;
-                if constexpr (std::is_signed_v<LL> == std::is_signed_v<RR>) {
-                    return std::conditional_t<(sizeof(LL) > sizeof(R)), LL, RR>{};
+                constexpr promotion policy = promotion_v<L, R>;
+                static_assert(policy != promotion::strict, "mixed element types under promotion::strict, convert one operand explicitly");
+                if constexpr (policy == promotion::left) {
+                    return L{};
                 } else {
-                    using S = std::conditional_t<std::is_signed_v<LL>, LL, RR>;
-                    using U = std::conditional_t<std::is_signed_v<LL>, RR, LL>;
-                    return std::conditional_t<(sizeof(U) >= sizeof(S)), U, S>{};
+                    using C = decltype(arithmetic_common_type<L, R>());
+#if defined(VECTOR_WARN_WIDENING)
+                    if constexpr (sizeof(C) > std::min(sizeof(L), sizeof(R))) {
+                        widening<L, R, C>();
+                    }
+#endif
+                    return C{};
                 }
             }
         }